@@ -13,6 +13,55 @@ See the Tutorial for more information
 #include <Arduino.h>
 #include "CommonBusEncoders.h"
 
+#define BUS_A 0x01                //Bit of Bus A in a sample of the busses
+#define BUS_B 0x02                //Bit of Bus B in a sample of the busses
+#define BUS_S 0x04                //Bit of Bus S in a sample of the busses
+
+#define ILLEGAL 2                 //A transition where both A and B changed (a state was missed)
+
+//The step taken by an encoder, indexed by (last state of AB << 2) | (new state of AB)
+//A state is (A << 1) | B, read in INPUT_PULLUP mode
+const int8_t transitions[16] PROGMEM = {
+//  new:  0        1        2        3
+          0,      -1,       1, ILLEGAL,        //last : 0
+          1,       0, ILLEGAL,      -1,        //last : 1
+         -1, ILLEGAL,       0,       1,        //last : 2
+    ILLEGAL,       1,      -1,       0         //last : 3
+};
+
+#if CBE_STATS
+#define STAT(x) (x)               //Count something in the statistics (see Stats)
+#else
+#define STAT(x)                   //Statistics left out
+#endif
+
+#define BARRIER() __asm__ __volatile__ ("" ::: "memory")   //Keep the compiler from moving memory accesses across this point
+
+//Holding interrupts around what tick() may change from a timer interrupt :
+//on AVR boards, they are enabled again only if they were (these may be called from an interrupt as well)
+#if defined(__AVR__)
+#define HOLD_INTERRUPTS()    uint8_t oldSREG = SREG; cli()
+#define RESTORE_INTERRUPTS() SREG = oldSREG
+#else
+#define HOLD_INTERRUPTS()    noInterrupts()
+#define RESTORE_INTERRUPTS() interrupts()
+#endif
+
+#define RELEASED 0                //The encoder's switch is released
+#define PRESSED  1                //The encoder's switch is pressed
+#define HELD     2                //The encoder's switch is pressed and the long press has been reported
+
+//The state of an encoder is packed in one byte :
+#define LAST_AB(s)      ((s) & 0x03)                                   //Last state of A and B (bits 0-1)
+#define BUSSES(s)       (((s) >> 2) & 0x07)                            //Debounced busses (bits 2-4)
+#define SWITCH(s)       (((s) >> 5) & 0x03)                            //State of the switch (bits 5-6)
+#define SETTLING        0x80                                           //A debounce counter has not reached it's bus (bit 7)
+#define SET_LAST_AB(s, v) ((s) = ((s) & ~0x03) | (v))
+#define SET_BUSSES(s, v)  ((s) = ((s) & ~(0x07 << 2)) | ((v) << 2))
+#define SET_SWITCH(s, v)  ((s) = ((s) & ~(0x03 << 5)) | ((v) << 5))
+
+#define SET_LANE(v, bit, on) ((v) = (on) ? ((v) | (bit)) : ((v) & ~(bit))) //Set or clear the bit of a bank
+
 //Constructor==============================================================================================
 //Connection :
 //    4 PinA--------+-----------+----------+-----Bus A        
@@ -34,24 +83,155 @@ See the Tutorial for more information
 //When it comes the time to read a particular encoder, it's common pin is brought to ground
 //The busses are placed in INPUT_PULLUP mode, so there is no need for resistors
 //Each encoder has several attributes, described below in the "addEncoder" method
-//These attributes are placed in a table called "encoders[]"
+//These attributes are placed in a table, encoderId 1 being the first entry
 //The constructor allocates the exact amount of memory needed for "count" encoders attached to the busses
-//The default attribute for the last status (HIGH or LOW) read on the Bus A for each encoder is HIGH
+//If that memory is not available, the bank is left with no encoder
+//"strobe" is the device that drives the common pins, if they are not Arduino pins (see CommonBusStrobe)
+//The last parameter is never given : it names the settings of the sketch, that must be those of the library (see Settings)
+//The default attribute for the last state of Bus A and Bus B for each encoder is HIGH (on detent)
+//On AVR boards, the port and bit of each bus are looked up once here, so that the busses
+//can be read directly from the port's input register instead of calling digitalRead()
 //-------------------------------------------------------------------------------------------------------------
-CommonBusEncoders::CommonBusEncoders(int pinA, int pinB, int pinS, int count) {
+CommonBusEncoders::CommonBusEncoders(int pinA, int pinB, int pinS, int count, CommonBusStrobe *strobe, Layout) {
+  MYstrobe = strobe;
+  MYtable = NULL;
+  MYblock = (byte*) calloc(1, configSize(count) + storageSize(count)); //Allocate memory for the encoders table
+  if (MYblock == NULL) count = 0;                             //Not enough memory : no encoder
+  MYconfig = (Config*) MYblock;                               //The attributes come first,
+  begin(pinA, pinB, pinS, count, MYblock + configSize(count)); //followed by the state
+}//Constructor-------------------------------------------------------------------------------------------------
+
+//Constructor (StaticCommonBusEncoders)=======================================================================
+//The attributes of the encoders are read from "table", in PROGMEM
+//The state of the encoders is kept in "storage" (storageSize(count) bytes), that is part of the object
+//Every encoder's common pin is attached right away
+//------------------------------------------------------------------------------------------------------------
+CommonBusEncoders::CommonBusEncoders(int pinA, int pinB, int pinS, int count, const Config *table, byte *storage, CommonBusStrobe *strobe, Layout) {
+  MYstrobe = strobe;
+  MYtable = table;
+  MYblock = NULL;
+  MYconfig = NULL;
+  begin(pinA, pinB, pinS, count, storage);
+  for (int i = 0 ; i < count ; i++) attach(i, config(i).pin);
+}//Constructor-------------------------------------------------------------------------------------------------
+
+//Constructor (several banks)=================================================================================
+//Up to 8 banks, each with it's own busses A, B and S, share the common pins :
+//a common pin enables one encoder in every bank, and the encoders of all the banks are read at once
+//pinsA, pinsB, pinsS : Arduino's pins of the busses of each bank (arrays of "banks" pins, kept by the sketch)
+//banks               : The number of banks (1..8)
+//count               : The number of encoders in all the banks
+//The encoders of a common pin are numbered together : with 4 banks, encoderId 1 to 4 are on the first
+//common pin (banks 1 to 4), encoderId 5 to 8 on the second one, and so on. Give them the same pin in addEncoder
+//On AVR boards, the busses are read with one read per bus when all the A busses are on one port,
+//all the B busses on one port and all the S busses on one port, bank n using the same bit of each
+//(on a Mega : A on 22..29 (PORTA), B on 37..30 (PORTC), S on 49..42 (PORTL)). Otherwise they are read pin by pin
+//------------------------------------------------------------------------------------------------------------
+CommonBusEncoders::CommonBusEncoders(const byte *pinsA, const byte *pinsB, const byte *pinsS, int banks, int count, CommonBusStrobe *strobe, Layout) {
+  banks = constrain(banks, 1, 8);
+  int slots = (count + banks - 1) / banks;
+  MYstrobe = strobe;
+  MYtable = NULL;
+  MYblock = (byte*) calloc(1, configSize(count) + storageSize(count) + slots * 5); //The encoders table and the banks' state
+  if (MYblock == NULL) count = 0;                             //Not enough memory : no encoder
+  MYconfig = (Config*) MYblock;
+  begin(pinsA[0], pinsB[0], pinsS[0], count, MYblock + configSize(count));
+  if (count > 0) beginBanks(pinsA, pinsB, pinsS, banks, MYblock + configSize(count) + storageSize(count));
+}//Constructor-------------------------------------------------------------------------------------------------
+
+//begin=======================================================================================================
+//Attaches the busses and lays out the state of the encoders in "storage"
+//Each attribute of the state has it's own array (the widest first, so that every array is aligned :
+//"storage" itself must be aligned for a pointer, see configSize)
+//------------------------------------------------------------------------------------------------------------
+void CommonBusEncoders::begin(int pinA, int pinB, int pinS, int count, byte *storage) {
   MYpinA = pinA;                //Pin of the bus A of the encoders
   MYpinB = pinB;                //Pin of the bus B of the encoders
 	MYpinS = pinS;                //Pin of the bus for the switches of the encoders
 	MYcount = count;              //The number of encoders attached to those busses
+  MYslots = count;              //One encoder per common pin
   pinMode(pinA, INPUT_PULLUP);
   pinMode(pinB, INPUT_PULLUP);
   pinMode(pinS, INPUT_PULLUP);
+#if defined(__AVR__)
+  MYregA = portInputRegister(digitalPinToPort(pinA));
+  MYregB = portInputRegister(digitalPinToPort(pinB));
+  MYregS = portInputRegister(digitalPinToPort(pinS));
+  MYmaskA = digitalPinToBitMask(pinA);
+  MYmaskB = digitalPinToBitMask(pinB);
+  MYmaskS = digitalPinToBitMask(pinS);
+  MYsamePort = (MYregA == MYregB) && (MYregA == MYregS);
+#endif
 
-  encoders = (encoder*) calloc(MYcount + 1, sizeof(encoder)); //Allocate memory for the encoders table
-  for (int i = 0 ; i <= count ; i++) {                        //For all encoders write defaults
-    encoders[i].lastA = 1;                                       //A is HIGH when the encoder is on detent
+  memset(storage, 0, storageSize(count));
+#if defined(__AVR__)
+  MYstrobeReg = (volatile uint8_t**) storage;    storage += count * sizeof(volatile uint8_t*);
+#endif
+  MYpressedAt = (uint16_t*) storage;             storage += count * sizeof(uint16_t);
+#if CBE_STATS
+  MYclicks = (uint16_t*) storage;                storage += count * sizeof(uint16_t);
+  memset(&MYstats, 0, sizeof(Stats));
+#endif
+#if defined(__AVR__)
+  MYstrobeMask = storage;                        storage += count;
+#endif
+  MYstate = storage;                             storage += count;
+  MYsteps = (int8_t*) storage;                   storage += count;
+  MYintegrator = storage;                        storage += count * 3;
+  MYmode = storage;
+  for (int i = 0 ; i < count ; i++) {                         //For all encoders write defaults
+    SET_LAST_AB(MYstate[i], 3);                                  //A and B are HIGH when the encoder is on detent
+    SET_BUSSES(MYstate[i], BUS_A | BUS_B | BUS_S);               //The busses are HIGH when nothing is closed
+    for (byte line = 0 ; line < 3 ; line++) MYintegrator[i * 3 + line] = 32;
   }
-}//Constructor-------------------------------------------------------------------------------------------------
+  for (byte h = 0 ; h < CBE_HOT_SIZE ; h++) MYhot[h] = -1;     //No encoder is active
+  MYlaneRest = NULL;
+  MYlaneBusy = NULL;
+  MYlaneActive = NULL;
+}//begin-------------------------------------------------------------------------------------------------------
+
+//beginBanks==================================================================================================
+//Attaches the busses of the other banks and lays out the state of the common pins in "storage" (5 bytes each)
+//On AVR boards, checks whether the busses can be read with one read per bus (see the Constructor)
+//------------------------------------------------------------------------------------------------------------
+void CommonBusEncoders::beginBanks(const byte *pinsA, const byte *pinsB, const byte *pinsS, int banks, byte *storage) {
+  MYbanks = banks;
+  MYslots = (MYcount + banks - 1) / banks;
+  MYpinsA = pinsA;
+  MYpinsB = pinsB;
+  MYpinsS = pinsS;
+  for (byte l = 1 ; l < banks ; l++) {
+    pinMode(pinsA[l], INPUT_PULLUP);
+    pinMode(pinsB[l], INPUT_PULLUP);
+    pinMode(pinsS[l], INPUT_PULLUP);
+  }
+#if defined(__AVR__)
+  MYlaneShift = 0;
+  while (MYlaneShift < 7 && !(MYmaskA & (1 << MYlaneShift))) MYlaneShift++; //Bit of bank 1's Bus A
+  MYlanesAligned = true;
+  for (byte l = 0 ; l < banks ; l++) {
+    int bit = 1 << (MYlaneShift + l);
+    if (portInputRegister(digitalPinToPort(pinsA[l])) != MYregA || digitalPinToBitMask(pinsA[l]) != bit ||
+        portInputRegister(digitalPinToPort(pinsB[l])) != MYregB || digitalPinToBitMask(pinsB[l]) != bit ||
+        portInputRegister(digitalPinToPort(pinsS[l])) != MYregS || digitalPinToBitMask(pinsS[l]) != bit) {
+      MYlanesAligned = false;                                       //Read pin by pin
+    }
+  }
+#endif
+  MYlaneRest = storage;                          storage += MYslots * 3;
+  MYlaneBusy = storage;                          storage += MYslots;
+  MYlaneActive = storage;
+  memset(MYlaneRest, 0xff, MYslots * 3);                        //The busses are HIGH when nothing is closed
+  memset(MYlaneBusy, 0, MYslots);
+  memset(MYlaneActive, 0, MYslots);
+}//beginBanks-------------------------------------------------------------------------------------------------
+
+//Destructor=================================================================
+//Frees the encoders table, for sketches that create banks with "new"
+//----------------------------------------------------------------------------
+CommonBusEncoders::~CommonBusEncoders() {
+  free(MYblock);
+}//Destructor------------------------------------------------------------------
 
 //addEncoder==================================================================================================
 //Used to add a new encoder on the bus
@@ -61,113 +241,241 @@ CommonBusEncoders::CommonBusEncoders(int pinA, int pinB, int pinS, int count) {
 //modes     : The number of modes that this encoder can take
 //indexE    : The index returned when the encoder is in it's first mode and is turned clockwise
 //indexS    : the index of the switch (0 if the encoder is multi mode, any index otherwise)
+//An encoderId outside of 1..count is ignored, as is any encoder of a StaticCommonBusEncoders
 //------------------------------------------------------------------------------------------------------------
 void CommonBusEncoders::addEncoder(int encoderId, int type, int pin, int modes, int indexE, int indexS) {   
-  encoders[encoderId].type = type;
-  encoders[encoderId].pin = pin;
-  encoders[encoderId].modes = modes;
-  encoders[encoderId].indexE = indexE;
-  encoders[encoderId].indexS = indexS;
+  if (MYconfig == NULL || encoderId < 1 || encoderId > MYcount) return;
+  Config &c = MYconfig[encoderId - 1];
+  c.type = type;
+  c.pin = pin;
+  c.modes = modes;
+  c.indexE = indexE;
+  c.indexS = indexS;
+  attach(encoderId - 1, pin);
+}//addEncoder---------------------------------------------------------------------------------------------------
+
+//attach======================================================================================================
+//Puts the common pin of encoder "i" in OUTPUT mode and sets it to HIGH (disabled)
+//On AVR boards, the port and bit of that pin are looked up once here
+//Nothing to do if the common pins are driven by a strobe device
+//------------------------------------------------------------------------------------------------------------
+void CommonBusEncoders::attach(int i, int pin) {
+  if (MYstrobe != NULL) return;
 	pinMode(pin, OUTPUT);
   digitalWrite(pin, HIGH);
-}//addEncoder---------------------------------------------------------------------------------------------------
+#if defined(__AVR__)
+  MYstrobeReg[i] = portOutputRegister(digitalPinToPort(pin));
+  MYstrobeMask[i] = digitalPinToBitMask(pin);
+#else
+  (void) i;                                       //Only the port and bit of the pin are kept
+#endif
+}//attach-------------------------------------------------------------------------------------------------------
+
+//config======================================================================================================
+//Returns the attributes of encoder "i", from RAM (addEncoder) or from PROGMEM (StaticCommonBusEncoders)
+//------------------------------------------------------------------------------------------------------------
+CommonBusEncoders::Config CommonBusEncoders::config(int i) {
+  Config c;
+  if (MYconfig != NULL) c = MYconfig[i];
+  else                  memcpy_P(&c, &MYtable[i], sizeof(Config));
+  return c;
+}//config-------------------------------------------------------------------------------------------------------
+
+//readBusses====================================================================================================
+//Takes one sample of the three busses and returns it in a single byte (BUS_A, BUS_B and BUS_S bits)
+//On AVR boards, when the three busses are on the same port, the sample is a single read of the port
+//Otherwise, each bus is read from it's own port register
+//On other boards, the busses are read with digitalRead()
+//---------------------------------------------------------------------------------------------------------------
+byte CommonBusEncoders::readBusses() {
+#if defined(__AVR__)
+  if (MYsamePort) {
+    uint8_t port = *MYregA;
+    return ((port & MYmaskA) ? BUS_A : 0) | ((port & MYmaskB) ? BUS_B : 0) | ((port & MYmaskS) ? BUS_S : 0);
+  }
+  return ((*MYregA & MYmaskA) ? BUS_A : 0) | ((*MYregB & MYmaskB) ? BUS_B : 0) | ((*MYregS & MYmaskS) ? BUS_S : 0);
+#else
+  return (digitalRead(MYpinA) ? BUS_A : 0) | (digitalRead(MYpinB) ? BUS_B : 0) | (digitalRead(MYpinS) ? BUS_S : 0);
+#endif
+}//readBusses----------------------------------------------------------------------------------------------------
+
+//readLanes=====================================================================================================
+//Takes one sample of the busses of every bank : bit n of "a", "b" and "s" is the Bus A, B and S of bank n + 1
+//On AVR boards, when the busses are wired as described in the Constructor, that is one read of each port
+//Otherwise, each bus is read with digitalRead()
+//---------------------------------------------------------------------------------------------------------------
+void CommonBusEncoders::readLanes(byte &a, byte &b, byte &s) {
+#if defined(__AVR__)
+  if (MYlanesAligned) {
+    a = *MYregA >> MYlaneShift;
+    b = *MYregB >> MYlaneShift;
+    s = *MYregS >> MYlaneShift;
+    return;
+  }
+#endif
+  a = b = s = 0;
+  for (byte l = 0 ; l < MYbanks ; l++) {
+    if (digitalRead(MYpinsA[l])) a |= 1 << l;
+    if (digitalRead(MYpinsB[l])) b |= 1 << l;
+    if (digitalRead(MYpinsS[l])) s |= 1 << l;
+  }
+}//readLanes-----------------------------------------------------------------------------------------------------
 
 //debounce======================================================================================================
-//debounces the switch connected to "pin"
-//The switch is read 16 times (~60us) to look for 16 consecutive HIGH or LOW
-//If unsuccessfull, it means that a change is occuring at that same moment
-//and that either a rising or falling edge of the signal is actualy occuring.
-//The pin is continuously read until the edge is confirmed.
-//returns 0 if closed or 1 if open in INPUT_PULLUP mode
-//returns 1 if closed or 0 if open in INPUT mode
+//Debounces the three busses of encoder "i", one sample at a time
+//Each bus has it's own counter (integrator) for each encoder:
+//  Every sample where the bus is HIGH counts up, every sample where it is LOW counts down (0..debounceWidth)
+//  The debounced bus only goes HIGH when the counter reaches "debounceWidth", and LOW when it reaches 0
+//A bouncing contact moves the counter back and forth without changing the debounced bus
+//The busses are never waited for, so a read always takes the same time
+//Returns the debounced state of the busses (BUS_A, BUS_B and BUS_S bits)
+//SETTLING is set in the encoder's state while a counter is on it's way to 0 or "debounceWidth"
+//A bit is 0 if closed or 1 if open in INPUT_PULLUP mode
 //See : http://www.ganssle.com/debouncing.htm to learn more about debouncing
 //This algorithm is inspired by that article
 //---------------------------------------------------------------------------------------------------------------
-int CommonBusEncoders::debounce(int pin) {
-	unsigned long pinStatus;
-	do {
-		pinStatus = 0xffffffff;
-		for (int i = 1; i <= debounceWidth; i++) pinStatus = (pinStatus << 1) | digitalRead(pin);
-	} while ((pinStatus != debounceDontCare) && (pinStatus != 0xffffffff));
-	return int(pinStatus & 0x00000001);
+byte CommonBusEncoders::debounce(int i, byte sample) {
+  byte bus = BUSSES(MYstate[i]);
+  bool settling = false;
+  for (byte line = 0 ; line < 3 ; line++) {                       //For busses A, B and S
+    byte bit = 1 << line;
+    byte count = min(MYintegrator[i * 3 + line], debounceWidth);    //The width may have been lowered
+    if (sample & bit) {                                             //HIGH : count up
+      if (count < debounceWidth) count++;
+      if (count == debounceWidth) bus |= bit;
+    }
+    else {                                                          //LOW : count down
+      if (count > 0) count--;
+      if (count == 0) bus &= ~bit;
+    }
+    MYintegrator[i * 3 + line] = count;
+    if (count != ((bus & bit) ? debounceWidth : 0)) settling = true; //The counter has not reached the bus
+  }
+  SET_BUSSES(MYstate[i], bus);
+  if (settling) MYstate[i] |= SETTLING;
+  else          MYstate[i] &= ~SETTLING;
+  STAT(MYstats.unsettled += settling);
+  return bus;
 }//debounce-------------------------------------------------------------------------------------------------------
 
-//readEncoder4============================================================================================
+//readQuadrature=========================================================================================
 // Single encoders (4 steps per detent) (When the encoder goes click and stays there)
 //  Detent is when both A and B are high in INPUT_PULLUP mode 
 //  Step :   1 2 3 4 5 6 7 8
 //      A:   1 0 0 1 1 0 0 1
 //      B:   0 0 1 1 0 0 1 1
-// CW  (Read left to right) When A Rises (4 and 8), B is high 
-// CCW (Read right to left) When A Rises (1 and 5), B is low 
+// CCW (Read left to right)
+// CW  (Read right to left)
+// Dual concentric encoders from Propwash (2 steps per detent)
+//  Detent is when both A and B are high and when both A and B are low
+//Every change of A and B is looked up in the "transitions" table :
+//  A valid step is added to (CW) or removed from (CCW) the steps counted since the last detent
+//  A change of both A and B means that a state was missed. The direction can not be known,
+//  so the steps counted are dropped instead of being miscounted
+//When the encoder reaches a detent, a click is returned if "type" steps were counted in the same direction
+//Returns : 0 = No click, 1 = CW click, -1 = CCW click
 //--------------------------------------------------------------------------------------------------------
-int CommonBusEncoders::readEncoder4(int i) {
-  int rotation = 0;                                   //Direction of rotation buffer (defaults to not turned)
-  int A = debounce(MYpinA);                           //Read the status of the bus on pinA
-	if ((!encoders[i].lastA) && (A)) {                  //If pin A is RISING (was low and is high),
-    int B = digitalRead(MYpinB);                        //Read the status of the bus on pinB
-
-    if (B) rotation = -1;                               //LOW  -> CCW  -> return -1
-    else   rotation =  1;                               //HIGH -> CW   -> return  1
-  }
-  encoders[i].lastA = A;                              //Update pinA's Status
-  return rotation;                                    //Return rotation
-}//readEncoder4--------------------------------------------------------------------------------------------
-
-//readEncoder2============================================================================================
-//Dual concentric encoders from Propwash (2 steps per detent)
-//We have to check when pinA goes from HIGH to LOW and when it goes from LOW to HIGH
-//--------------------------------------------------------------------------------------------------------
-int CommonBusEncoders::readEncoder2(int i) {
-  int rotation = 0 ;                               //Direction of rotation buffer
-  int A = debounce(MYpinA);                        //Read the status of the bus on pinA
-  int B = digitalRead(MYpinB);                     //Read the status of the bus on pinB
-  if ((encoders[i].lastA) && (!A)) {               //If pin A is FALLING (was high and is low),
-    if (B) rotation =  1;                            //HIGH -> CW   -> return  1
-    else   rotation = -1;                            //LOW  -> CCW  -> return -1
-  }
-  if ((!encoders[i].lastA) && (A)) {               //If pin A is RISING (was low and is high),
-    if (B) rotation = -1;                            //LOW  -> CCW  -> return -1
-    else   rotation =  1;                            //HIGH -> CW   -> return  1
-  }
-  encoders[i].lastA = A;                           //Update pinA's Status
-  return rotation;                                 //Return rotation
-}//readEncoder2-------------------------------------------------------------------------------------------
-
-//switchPressed========================================================================================
+int CommonBusEncoders::readQuadrature(int i, byte type, byte sample) {
+  int rotation = 0;                                            //Direction of rotation buffer (defaults to not turned)
+  byte AB = ((sample & BUS_A) ? 2 : 0) | ((sample & BUS_B) ? 1 : 0); //State of the busses A and B
+  byte lastAB = LAST_AB(MYstate[i]);
+  if (AB == lastAB) return 0;                                  //No change
+  int8_t step = pgm_read_byte(&transitions[(lastAB << 2) | AB]);
+  SET_LAST_AB(MYstate[i], AB);                                 //Update A and B's state
+  if (step == ILLEGAL) {                                       //If a state was missed,
+    STAT(MYstats.illegal++);
+    MYsteps[i] = 0;                                              //Drop the steps counted
+    return 0;
+  }
+  STAT(MYstats.reversed += (step > 0) ? (MYsteps[i] < 0) : (MYsteps[i] > 0)); //Turned back before the click
+  MYsteps[i] += step;                                          //Count the step
+  if (AB == 3 || (AB == 0 && type == 2)) {                     //If on detent,
+    if      (MYsteps[i] >=  type) rotation =  1;                 //Enough steps CW  -> return  1
+    else if (MYsteps[i] <= -type) rotation = -1;                 //Enough steps CCW -> return -1
+    STAT(MYclicks[i] += (rotation != 0));
+    MYsteps[i] = 0;                                              //Start counting for the next click
+  }
+  return rotation;                                             //Return rotation
+}//readQuadrature------------------------------------------------------------------------------------------
+
+//readSwitch===========================================================================================
 //The encoder's switch can be used change it's mode.
 //Modes are selected by pressing the switch
 //Every press takes the encoder to the next mode
 //When the last mode is active, another press brings the encoder to the first mode
 //See : https://www.arduino.cc/en/Reference/Modulo for the maths on how it's done
 //If number of modes is set to one, the switch can be used as a normal switch for other purposes
+//The switch is never waited for. Each read advances it's state by one step :
+//  RELEASED -> PRESSED : returns 9  (pressed)
+//  PRESSED  -> HELD    : returns 11 (held for more than "MYlongPress")
+//  PRESSED or HELD -> RELEASED : returns 10 (released)
+//Returns 0 if the state of the switch did not change
 //-----------------------------------------------------------------------------------------------------
-bool CommonBusEncoders::switchPressed(int i) {
-	if (!debounce(MYpinS)) {                               //If the switch is pressed,
-		encoders[i].currentMode =                              //Switch to next mode
-    (encoders[i].currentMode + 1) % encoders[i].modes;     //0, 1, 2, 3, 0, 1, 2, 3...
-		while (!debounce(MYpinS)) {}                           //Wait for the release of the switch
-    return true;                                           //return the fact that it has been pressed
-	}
-  return false;                                          //return the fact that it has NOT been pressed
-}//switchPressed----------------------------------------------------------------------------------------
+int CommonBusEncoders::readSwitch(int i, byte modes, byte sample) {
+  bool closed = !(sample & BUS_S);                       //LOW in INPUT_PULLUP mode when pressed
+  switch (SWITCH(MYstate[i])) {
+    case RELEASED: {
+      if (!closed) return 0;
+      SET_SWITCH(MYstate[i], PRESSED);
+      MYpressedAt[i] = millis();
+      MYmode[i] = (MYmode[i] + 1) % modes;                   //Switch to next mode : 0, 1, 2, 3, 0, 1, 2, 3...
+      return 9;
+    }
+    case PRESSED: {
+      if (!closed) { SET_SWITCH(MYstate[i], RELEASED); STAT(countHeld(i)); return 10; }
+      if ((uint16_t)((uint16_t)millis() - MYpressedAt[i]) < MYlongPress) return 0;
+      SET_SWITCH(MYstate[i], HELD);
+      return 11;
+    }
+    default: {
+      if (!closed) { SET_SWITCH(MYstate[i], RELEASED); STAT(countHeld(i)); return 10; }
+      return 0;
+    }
+  }
+}//readSwitch-------------------------------------------------------------------------------------------
+
+//strobe=============================================================================================
+//Brings the common pin of encoder "i" ("pin") to LOW (enable read) or HIGH (disable read)
+//On AVR boards, the port's output register is written directly
+//Interrupts are held while doing so, as digitalWrite() does, since the port may be shared
+//With a strobe device, enabling the encoder also disables the previous one, in a single transfer.
+//The encoder is left enabled until the next one is selected, so disabling it costs nothing
+//---------------------------------------------------------------------------------------------------
+void CommonBusEncoders::strobe(int i, byte pin, int level) {
+  if (MYstrobe != NULL) {
+    if (level == LOW) MYstrobe->select(pin);
+    return;
+  }
+#if defined(__AVR__)
+  HOLD_INTERRUPTS();
+  if (level) *MYstrobeReg[i] |= MYstrobeMask[i];
+  else       *MYstrobeReg[i] &= ~MYstrobeMask[i];
+  RESTORE_INTERRUPTS();
+#else
+  (void) i;                                       //The pin is written directly
+  digitalWrite(pin, level);
+#endif
+}//strobe--------------------------------------------------------------------------------------------
 
 //readEncoder========================================================================================
 //Returns : 0 = No action, 1 = Turned CW, -1 = Turned CCW, 9 = the switch was pressed
+//          10 = the switch was released, 11 = the switch is held (long press)
 //The selected encoder's common pin is brought to ground to enable a read
+//The busses are given "MYsettle" microseconds to settle, then sampled once
+//That sample is debounced and used for the rotation and the switch
 //The encoder is read depending on the number of steps per detent
 //if it was not rotated, it's switch is checked, and a flag will be returned
 //The selected encoder's common pin is raised to disable a read
 //---------------------------------------------------------------------------------------------------
 int CommonBusEncoders::readEncoder(int i) {
   int rotation = 0;
-	digitalWrite(encoders[i].pin, LOW);                    //Enable read
-	switch (encoders[i].type) {                              //Read encoder according to it's type:
-  	case 2: { rotation = readEncoder2(i); break; }           // 2 steps per detent
-  	case 4: { rotation = readEncoder4(i); break; }           // 4 steps per detent
-	}
-	if (rotation == 0 && switchPressed(i)) rotation = 9;    //No rotation : Flag the switch if pressed
-	digitalWrite(encoders[i].pin, HIGH);                   //Disable read
+  Config c = config(i);                                  //The encoder's attributes
+	strobe(i, c.pin, LOW);                                 //Enable read
+  delayMicroseconds(MYsettle);                           //Let the busses settle
+  byte sample = debounce(i, readBusses());               //Sample and debounce the busses
+	rotation = readQuadrature(i, c.type, sample);            //Decode the rotation
+	if (rotation == 0) rotation = readSwitch(i, c.modes, sample); //No rotation : Flag the switch's changes
+	strobe(i, c.pin, HIGH);                                //Disable read
   return rotation;                                       //Return the rotation
 }//readEncoder----------------------------------------------------------------------------------------
 
@@ -182,51 +490,326 @@ int CommonBusEncoders::readEncoder(int i) {
 //The switch is also fitted with an index.
 //If the encoder has more than one mode, then the index shall be 0
 //If the encoder has only one mode, the switch can be used for anything else and be given it's own index
+//The release and the long press of the switch have their own indexes (see setSwitchIndexes)
 //---------------------------------------------------------------------------------------------------------
-int CommonBusEncoders::getIndex(int i) {
-	int rotation = readEncoder(i);
-
+int CommonBusEncoders::getIndex(int i, int rotation) {
+  if (rotation == 0) return 0;                           //No action
+  Config c = config(i);
   switch (rotation) {
-	  case  1: { return encoders[i].indexE + encoders[i].currentMode * 2; break; }
-	  case -1: { return encoders[i].indexE + encoders[i].currentMode * 2 + 1; break; }
-		case  9: { return encoders[i].indexS; break; }
+	  case  1: { return c.indexE + MYmode[i] * 2; break; }
+	  case -1: { return c.indexE + MYmode[i] * 2 + 1; break; }
+		case  9: { return c.indexS; break; }
+		case 10: { return c.indexR; break; }
+		case 11: { return c.indexL; break; }
 		default: { return 0; break; }
   }
 }//getIndex------------------------------------------------------------------------------------------------
 
 //readAll========================================================================================================
-//Reads all the encoders
-//Using an encoder raises a flag to give 
-//The priority is canceled after an inactivity is observed beyond "MYactiveTimeLimit" (1/2 second by default)
-//If the current encoder is still active, return it's index or return 0
-//If not, read all the encoders 
+//Reads the encoders and returns the index of the oldest action taken (0 if none)
+//Using an encoder places it in a set of active encoders (up to CBE_HOT_SIZE, 4 by default)
+//The active encoders are read on every call
+//The other encoders are read "MYsweep" at a time (1 by default), so every idle encoder is still read
+//at least once every (count / MYsweep) calls, and using two encoders at once keeps both responsive
+//An encoder joins the set on the first read where it's busses move, before it's click is complete :
+//a change of a bus is confirmed after "width" reads (see setDebounce), that is width x (count / MYsweep)
+//calls at worst for an encoder kept out of the set (more than CBE_HOT_SIZE knobs moving at once)
+//When no encoder is active, or in full scan mode (see setFullScan), every encoder is read
+//An encoder leaves the set after an inactivity beyond "MYactiveTimeLimit" (1/2 second by default),
+//and it's mode is reset to 0
+//With several banks, the encoders of a common pin are read together, so the set and the sweep count common pins
+//Every action taken is queued, so no action is lost when several encoders are used at once
+//In background mode (see setBackground), the encoders are read by tick() and readAll() only takes from the queue
 //----------------------------------------------------------------------------------------------------------------
 int CommonBusEncoders::readAll() {
-  static int currentEncoder = 0;                                  //To concentrate on the current encoder
-  int index = 0;                                                  //Default index is 0 (no action)
-  if (millis() - MYchrono > MYactiveTimeLimit) {                  //If it is timeout for the current encoder
-    encoders[currentEncoder].currentMode = 0;                       //Reset the mode to 0
-    currentEncoder = 0;                                             //Cancel current encoder
-    isFocussed = false;                                             //not focussed on any encoder
-  }
-	if (currentEncoder != 0 ) {                                     //If an encoder is currently in use
-    index = getIndex(currentEncoder);                               //Get it's index
-		if (index != 0) {	MYchrono = millis(); return index; }          //If active, reset chrono and return
-		else            { return 0; }                                   //Else, return no index
-	}
-
-  for (int i = 1 ; i <= MYcount ; i++) {                          //For each encoder
-  	index = getIndex(i);                                            //Get it's index
-		if (index != 0) {                                               //If it is active,
-      currentEncoder = i;                                             //Make it the current encoder
-      MYchrono = millis();                                            //Reset MYchrono
-      isFocussed = true;                                              //Now focussed on an encoder
-      return index;                                                   //Return it's index
+  if (!MYbackground) {                                            //Unless tick() reads the encoders
+#if CBE_STATS
+    unsigned long start = micros();
+#endif
+    expireHot();                                                    //Let go of the inactive encoders
+    bool hot = focussed();
+    for (byte h = 0 ; h < CBE_HOT_SIZE ; h++) {                     //Read the active encoders
+      if (MYhot[h] >= 0) scanSlot(MYhot[h]);
     }
+    if (MYfullScan || !hot) sweep(MYslots);                         //Read all the other encoders
+    else                    sweep(MYsweep);                         //Or the next few of them
+    STAT(countRead(micros() - start));
   }
-  return 0;                                                       //Else, return no index
+  Event e;
+  if (poll(e)) return e.index;                                    //Return the oldest index
+  return 0;                                                       //Or no index
 }//readAll----------------------------------------------------------------------------------------------------
 
+//scan===========================================================================================================
+//Reads every encoder once and adds each action taken to the queue
+//Actions with an index of 0 are not queued
+//----------------------------------------------------------------------------------------------------------------
+void CommonBusEncoders::scan() {
+  expireHot();                                                    //Let go of the inactive encoders
+  for (int i = 0 ; i < MYslots ; i++) scanSlot(i);               //For each common pin, read it's encoders and queue their actions
+}//scan-----------------------------------------------------------------------------------------------------------
+
+//tick===========================================================================================================
+//Reads one encoder and adds the action taken to the queue
+//Meant to be called at a steady rate from a timer interrupt (see the Background example),
+//or from anything else that keeps time, such as a simulated clock
+//Ticks alternate between the active encoders and the idle ones (round robin in both cases),
+//so an idle encoder is read at least once every (2 x count) ticks (2 x count / banks with several banks)
+//Latency : a change of a bus is confirmed after "width" reads of the encoder (see setDebounce)
+//  An encoder joins the set on the first read where it's busses move, so a knob is noticed within
+//  (2 x count) ticks, and the rest is read every (2 x CBE_HOT_SIZE) ticks at worst
+//  The worst case, width x 2 x count ticks, is that of an encoder kept out of the set (more than
+//  CBE_HOT_SIZE knobs moving at once) : at 1kHz, 19 encoders and a width of 4, 152ms for each change
+//  A knob that leaves it's first state before it is noticed loses that click (see extras/host)
+//The queue is safe to be filled here while the sketch takes from it with readAll(), poll() or readEvents() :
+//it has a single producer and a single consumer. Called from an interrupt, tick() must be the only one to read
+//the encoders, so call setBackground(true) first and do not call scan() : readAll() would otherwise fill the queue
+//(and the set of active encoders) at the same time
+//----------------------------------------------------------------------------------------------------------------
+void CommonBusEncoders::tick() {
+  expireHot();                                                    //Let go of the inactive encoders
+  int i = -1;
+  if (MYtickHot) i = nextHot();                                   //An active encoder, if any
+  MYtickHot = !MYtickHot;
+  if (i >= 0) scanSlot(i);
+  else        sweep(1);                                           //Or the next idle encoder
+}//tick-----------------------------------------------------------------------------------------------------------
+
+//scanEncoder====================================================================================================
+//Reads encoder "i" and adds the action taken to the queue
+//The encoder joins the set of active encoders as soon as it's busses move (see isMoving),
+//not only once a click is complete, so the rest of the click is read at the pace of the active encoders
+//----------------------------------------------------------------------------------------------------------------
+void CommonBusEncoders::scanEncoder(int i) {
+  byte before = MYstate[i];
+  int rotation = readEncoder(i);                                  //Read it
+  int index = getIndex(i, rotation);                              //Get it's index
+  if (index != 0) queue(i, rotation, index);                      //If it is active, queue the action
+  if (index != 0 || isMoving(before, MYstate[i])) touch(i);       //It is now an active encoder
+}//scanEncoder----------------------------------------------------------------------------------------------------
+
+//scanBanks======================================================================================================
+//Reads the encoders of every bank on common pin "s" and adds the actions taken to the queue
+//The busses of all the banks are sampled at once, one bit per bank (see readLanes)
+//A bank whose busses are the same as their debounced state, that has no debounce counter on it's way
+//and no switch waiting for a long press has nothing to report : those are found for all the banks at once,
+//and only the others are debounced and decoded
+//The common pin joins the set of active encoders as soon as the busses of one of it's encoders move (see isMoving)
+//----------------------------------------------------------------------------------------------------------------
+void CommonBusEncoders::scanBanks(int s) {
+  int first = s * MYbanks;                                        //The encoder of bank 1 on that common pin
+  byte valid = (1 << min((int)MYbanks, MYcount - first)) - 1;     //The last common pin may have fewer encoders
+  byte pin = config(first).pin;
+  strobe(first, pin, LOW);                                        //Enable read
+  delayMicroseconds(MYsettle);                                    //Let the busses settle
+  byte a, b, sw;
+  readLanes(a, b, sw);                                            //Sample every bank
+  strobe(first, pin, HIGH);                                       //Disable read
+  byte *rest = &MYlaneRest[s * 3];
+  byte changed = ((a ^ rest[0]) | (b ^ rest[1]) | (sw ^ rest[2]) | MYlaneBusy[s]) & valid;
+  for (byte l = 0 ; changed != 0 ; l++, changed >>= 1) {          //For each bank with something to report
+    if (!(changed & 1)) continue;
+    int i = first + l;
+    byte bit = 1 << l;
+    Config c = config(i);
+    byte before = MYstate[i];
+    byte sample = debounce(i, ((a & bit) ? BUS_A : 0) | ((b & bit) ? BUS_B : 0) | ((sw & bit) ? BUS_S : 0));
+    int rotation = readQuadrature(i, c.type, sample);              //Decode the rotation
+    if (rotation == 0) rotation = readSwitch(i, c.modes, sample);  //No rotation : Flag the switch's changes
+    SET_LANE(rest[0], bit, sample & BUS_A);                        //Keep the debounced busses of the banks
+    SET_LANE(rest[1], bit, sample & BUS_B);
+    SET_LANE(rest[2], bit, sample & BUS_S);
+    SET_LANE(MYlaneBusy[s], bit, (MYstate[i] & SETTLING) || SWITCH(MYstate[i]) == PRESSED);
+    int index = getIndex(i, rotation);                              //Get it's index
+    if (index != 0) queue(i, rotation, index);                      //If it is active, queue the action
+    if (index != 0 || isMoving(before, MYstate[i])) {
+      if (!isHot(s)) MYlaneActive[s] = 0;                             //Joining the set : no encoder active yet
+      touch(s);                                                       //It's common pin is now active
+      MYlaneActive[s] |= bit;                                         //And so is this encoder (see expireHot)
+    }
+  }
+}//scanBanks------------------------------------------------------------------------------------------------------
+
+//scanSlot=======================================================================================================
+//Reads the encoders on common pin "s" and adds the actions taken to the queue
+//With a single bank, that is encoder "s"
+//----------------------------------------------------------------------------------------------------------------
+void CommonBusEncoders::scanSlot(int s) {
+  if (MYbanks == 1) scanEncoder(s);
+  else              scanBanks(s);
+}//scanSlot-------------------------------------------------------------------------------------------------------
+
+//sweep==========================================================================================================
+//Reads the next "n" encoders (common pins) that are not in the set of active encoders (they are read on their own)
+//Continues where the last sweep stopped
+//----------------------------------------------------------------------------------------------------------------
+void CommonBusEncoders::sweep(int n) {
+  for (int tries = 0 ; n > 0 && tries < MYslots ; tries++) {     //At most once around the bank
+    int i = MYcursor;
+    MYcursor = (MYcursor + 1) % MYslots;                            //0, 1, 2, ... count - 1, 0, 1...
+    if (isHot(i)) continue;                                         //Already read
+    scanSlot(i);
+    n--;
+  }
+}//sweep----------------------------------------------------------------------------------------------------------
+
+//isMoving=======================================================================================================
+//Returns true if an encoder's state went from "before" to "after" while it's busses moved :
+//a debounce counter is on it's way (the sample differs from the debounced busses), or a debounced bus changed
+//That is the first sign of a knob being turned or pressed, long before a click is complete
+//----------------------------------------------------------------------------------------------------------------
+bool CommonBusEncoders::isMoving(byte before, byte after) {
+  return (after & SETTLING) || BUSSES(before) != BUSSES(after);
+}//isMoving-------------------------------------------------------------------------------------------------------
+
+//isHot==========================================================================================================
+//Returns true if encoder "i" is in the set of active encoders
+//----------------------------------------------------------------------------------------------------------------
+bool CommonBusEncoders::isHot(int i) {
+  for (byte h = 0 ; h < CBE_HOT_SIZE ; h++) if (MYhot[h] == i) return true;
+  return false;
+}//isHot----------------------------------------------------------------------------------------------------------
+
+//touch==========================================================================================================
+//Places encoder "i" in the set of active encoders and notes when it was active
+//If the set is full, the encoder that has been inactive for the longest time makes room
+//----------------------------------------------------------------------------------------------------------------
+void CommonBusEncoders::touch(int i) {
+  unsigned long now = millis();
+  byte slot = 0;
+  for (byte h = 0 ; h < CBE_HOT_SIZE ; h++) {
+    if (MYhot[h] == i) { slot = h; break; }                         //Already active
+    if (MYhot[slot] >= 0 &&                                         //A free slot,
+       (MYhot[h] < 0 || MYhotTime[h] < MYhotTime[slot])) slot = h;  //or else the least recently active
+  }
+  STAT(MYstats.focusSwitches += (MYhot[slot] != i));
+  MYhot[slot] = i;
+  MYhotTime[slot] = now;
+}//touch----------------------------------------------------------------------------------------------------------
+
+//expireHot======================================================================================================
+//Removes the encoders that were inactive beyond "MYactiveTimeLimit" from the set of active encoders
+//Their mode is reset to 0 (with several banks, the mode of the encoders of that common pin that were active
+//since it joined the set, the others keep theirs)
+//----------------------------------------------------------------------------------------------------------------
+void CommonBusEncoders::expireHot() {
+  unsigned long now = millis();
+  for (byte h = 0 ; h < CBE_HOT_SIZE ; h++) {
+    if (MYhot[h] >= 0 && now - MYhotTime[h] > MYactiveTimeLimit) {  //If it is timeout for that encoder
+      if (MYbanks == 1) MYmode[MYhot[h]] = 0;                         //Reset the mode to 0
+      else {
+        int first = MYhot[h] * MYbanks;
+        for (byte l = 0 ; l < MYbanks && first + l < MYcount ; l++) {
+          if (MYlaneActive[MYhot[h]] & (1 << l)) MYmode[first + l] = 0; //Of the encoders that were active only
+        }
+        MYlaneActive[MYhot[h]] = 0;
+      }
+      MYhot[h] = -1;                                                  //It is no longer active
+      STAT(MYstats.timeouts++);
+    }
+  }
+}//expireHot------------------------------------------------------------------------------------------------------
+
+//nextHot========================================================================================================
+//Returns the next encoder in the set of active encoders (round robin), or -1 if the set is empty
+//----------------------------------------------------------------------------------------------------------------
+int CommonBusEncoders::nextHot() {
+  for (byte n = 0 ; n < CBE_HOT_SIZE ; n++) {
+    byte h = MYhotNext;
+    MYhotNext = (MYhotNext + 1) % CBE_HOT_SIZE;
+    if (MYhot[h] >= 0) return MYhot[h];
+  }
+  return -1;
+}//nextHot--------------------------------------------------------------------------------------------------------
+
+//queue==========================================================================================
+//Adds an event at the head of the queue
+//If the queue is full, the event is dropped and counted in "MYoverflows"
+//Only the head is written here and only the tail is written by poll(),
+//so events can be queued and taken from two different contexts, one each (see tick)
+//The head and the tail count the events written and taken (modulo 256), and the queue holds
+//head - tail events : all CBE_QUEUE_SIZE entries are used (hence CBE_QUEUE_SIZE up to 128)
+//-----------------------------------------------------------------------------------------------
+void CommonBusEncoders::queue(int i, int rotation, int index) {
+  byte head = MYhead;
+  if ((byte)(head - MYtail) == CBE_QUEUE_SIZE) { MYoverflows++; return; } //Full : drop the event
+  Event &e = MYqueue[head & (CBE_QUEUE_SIZE - 1)];
+  e.index = index;
+  e.encoderId = i + 1;                                            //Encoders are numbered from 1
+  e.action = rotation;
+  BARRIER();                                                      //The event is written before it is published
+  MYhead = head + 1;
+}//queue-----------------------------------------------------------------------------------------
+
+//poll===========================================================================================
+//Takes the oldest event from the queue
+//Returns false if the queue is empty
+//-----------------------------------------------------------------------------------------------
+bool CommonBusEncoders::poll(Event &e) {
+  byte tail = MYtail;
+  if (tail == MYhead) return false;                               //Empty
+  BARRIER();                                                      //The event is read after it is published
+  e = MYqueue[tail & (CBE_QUEUE_SIZE - 1)];
+  BARRIER();                                                      //The event is read before it's entry is given back
+  MYtail = tail + 1;
+  return true;
+}//poll------------------------------------------------------------------------------------------
+
+//readEvents=====================================================================================
+//Takes up to "n" events from the queue into "buf"
+//Returns the number of events taken
+//-----------------------------------------------------------------------------------------------
+int CommonBusEncoders::readEvents(Event *buf, int n) {
+  int count = 0;
+  while (count < n && poll(buf[count])) count++;
+  return count;
+}//readEvents------------------------------------------------------------------------------------
+
+//pending========================================================================================
+//Returns the number of events waiting in the queue
+//-----------------------------------------------------------------------------------------------
+int CommonBusEncoders::pending() {
+  return (byte)(MYhead - MYtail);
+}//pending---------------------------------------------------------------------------------------
+
+//overflows======================================================================================
+//Returns the number of events that were lost because the queue was full
+//-----------------------------------------------------------------------------------------------
+unsigned long CommonBusEncoders::overflows() {
+  HOLD_INTERRUPTS();                                              //May be counted by tick() in an interrupt
+  unsigned long count = MYoverflows;
+  RESTORE_INTERRUPTS();
+  return count;
+}//overflows-------------------------------------------------------------------------------------
+
+//setFullScan====================================================================
+//In full scan mode, readAll() reads every encoder on every call,
+//instead of the active encoders and the next "MYsweep" idle ones
+//The queue can also be emptied directly with poll() or readEvents()
+//-------------------------------------------------------------------------------
+void CommonBusEncoders::setFullScan(bool on) {
+  MYfullScan = on;
+}//setFullScan-------------------------------------------------------------------
+
+//setBackground==================================================================
+//In background mode, the encoders are only read by tick(), called from a timer
+//readAll() then only takes the oldest index from the queue, and never reads an encoder
+//The sketch's loop() can be as slow as it needs to be, as long as the queue is emptied in time
+//It must be on before tick() is called from an interrupt, so that the queue has a single producer
+//-------------------------------------------------------------------------------
+void CommonBusEncoders::setBackground(bool on) {
+  MYbackground = on;
+}//setBackground-------------------------------------------------------------------
+
+//setSweep=======================================================================
+//Sets the number of idle encoders read by readAll() while some encoders are active
+//An idle encoder is then read at least once every (count / perCall) calls
+//It defaults to 1
+//--------------------------------------------------------------------------------
+void CommonBusEncoders::setSweep(int perCall) {
+  MYsweep = constrain(perCall, 1, MYslots);
+}//setSweep-----------------------------------------------------------------------
+
 //resetChronoAfter=====================================================
 //When an encoder is activated, it recieves priority for future reads.
 //The actual time this priority is kept is set by this method
@@ -238,18 +821,145 @@ void CommonBusEncoders::resetChronoAfter(int aDelay) {
 
 
 //setDebounce=====================================================================
-//Sets the number of times a switch is read repeatedly by the debouncer routine
-//It defaults to 16 times. Allowable values are 1..32
+//Sets the number of consecutive reads of an encoder that confirm a change of a bus
+//An encoder is read once each time readAll() (or scan) reads it
+//It defaults to 4 reads. Allowable values are 1..32
+//Before, it counted samples taken back to back within one read (16 by default) : old values do not carry over
 //--------------------------------------------------------------------------------
 void CommonBusEncoders::setDebounce(int w) {
-  debounceWidth = w;
-	unsigned long debounceDontCare = 0xffffffff;
-	for (int i = 0; i < w; i++) debounceDontCare = debounceDontCare << 1 | 0;
+  debounceWidth = constrain(w, 1, 32);
+  if (MYlaneBusy != NULL) memset(MYlaneBusy, 0xff, MYslots);      //The counters are no longer where they stopped
 }//setDebounce--------------------------------------------------------------------
 
+//setSettle=======================================================================
+//Sets the time given to the busses to settle after an encoder is enabled
+//The busses are pulled up by the Arduino's internal resistors and need a few
+//microseconds to rise after the previous encoder is disabled
+//"us" is expressed in microseconds. The default is 5us
+//--------------------------------------------------------------------------------
+void CommonBusEncoders::setSettle(int us) {
+  MYsettle = constrain(us, 0, 255);
+}//setSettle----------------------------------------------------------------------
+
+//setSwitchIndexes===========================================================
+//Gives indexes to the release and to the long press of an encoder's switch
+//indexR : The index returned when the switch is released
+//indexL : The index returned when the switch is held longer than the long press delay
+//Both default to 0 : only the press of the switch is reported (indexS)
+//For a StaticCommonBusEncoders, they are given in the table instead
+//----------------------------------------------------------------------------
+void CommonBusEncoders::setSwitchIndexes(int encoderId, int indexR, int indexL) {
+  if (MYconfig == NULL || encoderId < 1 || encoderId > MYcount) return;
+  MYconfig[encoderId - 1].indexR = indexR;
+  MYconfig[encoderId - 1].indexL = indexL;
+}//setSwitchIndexes-----------------------------------------------------------
+
+//setLongPress========================================================
+//Sets the time a switch has to be held before a long press is reported
+//"aDelay" is expressed in milliseconds. The default is 1000ms
+//It is kept within 0..65535ms (about 65s) : the press time is held on 16 bits (see MYpressedAt)
+//"aDelay" is unsigned long, so that the whole range can be given on boards where int is 16 bits
+//Near that limit, the switch must be read before it's 16 bits count wraps, 65536ms after the press
+//--------------------------------------------------------------------
+void CommonBusEncoders::setLongPress(unsigned long aDelay) {
+  MYlongPress = min(aDelay, 65535UL);
+}//setLongPress-------------------------------------------------------
+
+//memoryUsed==================================================================
+//Returns the number of bytes of RAM used by this bank of encoders :
+//the object itself, the attributes of the encoders (unless they are in PROGMEM)
+//and their state (see CBE_STROBE_BYTES and CBE_STATE_BYTES, plus 5 bytes per common pin with several banks)
+//----------------------------------------------------------------------------
+unsigned int CommonBusEncoders::memoryUsed() {
+  unsigned int bytes = sizeof(CommonBusEncoders) + storageSize(MYcount);
+  if (MYconfig != NULL) bytes += configSize(MYcount);
+  if (MYlaneRest != NULL) bytes += MYslots * 5;
+  return bytes;
+}//memoryUsed-----------------------------------------------------------------
+
+#if CBE_STATS
+//countRead===================================================================
+//Counts a readAll() call that took "spent" microseconds in the statistics
+//----------------------------------------------------------------------------
+void CommonBusEncoders::countRead(unsigned long spent) {
+  byte bucket = 0;
+  while (bucket < CBE_STATS_BUCKETS - 1 && spent >= (16UL << bucket)) bucket++;
+  MYstats.readHistogram[bucket]++;
+  MYstats.reads++;
+  if (spent > MYstats.readMax) MYstats.readMax = spent;
+}//countRead-------------------------------------------------------------------
+
+//countHeld===================================================================
+//Counts the time the switch of encoder "i" was held down, when it is released
+//----------------------------------------------------------------------------
+void CommonBusEncoders::countHeld(int i) {
+  MYstats.switchHeld += (uint16_t)((uint16_t)millis() - MYpressedAt[i]);
+}//countHeld-------------------------------------------------------------------
+
+//stats=======================================================================
+//Copies the statistics gathered since the last resetStats() in "s"
+//Only compiled in when CBE_STATS is 1 (see CommonBusEncoders.h)
+//----------------------------------------------------------------------------
+void CommonBusEncoders::stats(Stats &s) {
+  HOLD_INTERRUPTS();                                              //May be counted by tick() in an interrupt
+  s = MYstats;
+  RESTORE_INTERRUPTS();
+}//stats-----------------------------------------------------------------------
+
+//clicks======================================================================
+//Returns the number of clicks (CW and CCW) of an encoder since the last resetStats()
+//It wraps around after 65535 clicks
+//----------------------------------------------------------------------------
+unsigned int CommonBusEncoders::clicks(int encoderId) {
+  if (encoderId < 1 || encoderId > MYcount) return 0;
+  HOLD_INTERRUPTS();
+  unsigned int count = MYclicks[encoderId - 1];
+  RESTORE_INTERRUPTS();
+  return count;
+}//clicks----------------------------------------------------------------------
+
+//resetStats==================================================================
+//Starts the statistics over
+//----------------------------------------------------------------------------
+void CommonBusEncoders::resetStats() {
+  HOLD_INTERRUPTS();
+  memset(&MYstats, 0, sizeof(Stats));
+  memset(MYclicks, 0, MYcount * sizeof(uint16_t));
+  RESTORE_INTERRUPTS();
+}//resetStats------------------------------------------------------------------
+
+//dumpStats===================================================================
+//Writes the statistics to "out" (Serial, for example) in binary, little endian :
+//  "CBE" and the version of the layout (1)      : 4 bytes
+//  The number of buckets (CBE_STATS_BUCKETS)    : 1 byte
+//  The members of Stats, in order               : 4 bytes each
+//  The number of encoders                       : 2 bytes
+//  The clicks of each encoder                   : 2 bytes each
+//----------------------------------------------------------------------------
+void CommonBusEncoders::dumpStats(Print &out) {
+  Stats s;
+  stats(s);
+  out.write((const uint8_t*) "CBE\x01", 4);
+  out.write((uint8_t) CBE_STATS_BUCKETS);
+  const unsigned long *field = (const unsigned long*) &s;
+  for (byte n = 0 ; n < sizeof(Stats) / sizeof(unsigned long) ; n++) {
+    unsigned long v = field[n];
+    for (byte b = 0 ; b < 4 ; b++) { out.write((uint8_t) v); v >>= 8; }
+  }
+  out.write((uint8_t) MYcount);
+  out.write((uint8_t) (MYcount >> 8));
+  for (int i = 1 ; i <= MYcount ; i++) {
+    unsigned int v = clicks(i);
+    out.write((uint8_t) v);
+    out.write((uint8_t) (v >> 8));
+  }
+}//dumpStats-------------------------------------------------------------------
+#endif
+
 //focussed===================================
-//Returns true if an ender has focus
+//Returns true if an encoder is active
 //-------------------------------------------
 bool CommonBusEncoders::focussed() {
-	return isFocussed;
+  for (byte h = 0 ; h < CBE_HOT_SIZE ; h++) if (MYhot[h] >= 0) return true;
+	return false;
 }//focussed----------------------------------
\ No newline at end of file
@@ -16,45 +16,255 @@
 
 #include "Arduino.h"
 
+//Settings======================================================================================
+//CBE_QUEUE_SIZE, CBE_HOT_SIZE and CBE_STATS change the attributes of CommonBusEncoders, so the library
+//and the sketch must be compiled with the same values. The library is compiled apart from the sketch :
+//a sketch that defines them before including this file would not change the library, only it's own view
+//of the class. Change them here instead (or give them to the compiler for the library and the sketch alike).
+//The constructors are tagged with the settings they were compiled with (see CommonBusLayout), so a sketch
+//compiled with other settings does not link : "undefined reference to CommonBusEncoders::CommonBusEncoders(...,
+//CommonBusLayout<8, 4, 0>)" means that the sketch's settings (here, a queue of 8) differ from the library's.
+//------------------------------------------------------------------------------------------------
+#ifndef CBE_QUEUE_SIZE
+#define CBE_QUEUE_SIZE 16                         //Number of events the queue can hold (a power of 2, up to 128)
+#endif
+static_assert(CBE_QUEUE_SIZE >= 1 && CBE_QUEUE_SIZE <= 128 && (CBE_QUEUE_SIZE & (CBE_QUEUE_SIZE - 1)) == 0,
+              "CBE_QUEUE_SIZE must be a power of 2, up to 128");
+
+#ifndef CBE_HOT_SIZE
+#define CBE_HOT_SIZE 4                            //Number of recently active encoders read on every readAll()
+#endif
+
+#ifndef CBE_STATS
+#define CBE_STATS 0                               //1 : collect statistics on the reads (see Stats), 0 : leave them out
+#endif
+
+#define CBE_STATS_BUCKETS 8                       //Buckets of the readAll() durations (see Stats)
+
+#if defined(__AVR__)
+#define CBE_STROBE_BYTES (sizeof(volatile uint8_t *) + 1) //RAM per encoder to write it's common pin directly
+#else
+#define CBE_STROBE_BYTES 0
+#endif
+#define CBE_STATE_BYTES (sizeof(uint16_t) + 6)    //RAM per encoder for it's state (see the attributes below)
+#if CBE_STATS
+#define CBE_STATS_BYTES sizeof(uint16_t)          //RAM per encoder for it's clicks count
+#else
+#define CBE_STATS_BYTES 0
+#endif
+
+//CommonBusStrobe=================================================================================
+//The interface of the devices that drive the encoders' common pins (see ShiftRegisterStrobe.h,
+//SPIStrobes.h and MCP23017Strobe.h). Without one, the common pins are Arduino pins.
+//select() enables a single common pin (LOW) and disables all the others (HIGH) in one transfer,
+//so moving from an encoder to the next costs a single transfer. line -1 disables them all.
+//transfers() counts the transfers made, to know what each scan costs.
+//------------------------------------------------------------------------------------------------
+class CommonBusStrobe
+{
+  public:
+    virtual void select(int line) = 0;            //Enable the common pin on "line" and disable the others
+    unsigned long transfers() { return MYtransfers; }  //Number of transfers made so far
+  protected:
+    unsigned long MYtransfers = 0;                //Number of transfers made so far
+};
+
+//CommonBusLayout=================================================================================
+//Names the settings that change the layout of CommonBusEncoders (see Settings above)
+//------------------------------------------------------------------------------------------------
+template <int queueSize, int hotSize, int stats>
+struct CommonBusLayout {};
+
 class CommonBusEncoders
 {
   public:
+    typedef CommonBusLayout<CBE_QUEUE_SIZE, CBE_HOT_SIZE, CBE_STATS> Layout; //The settings this class is compiled with
+    struct Event {                                //An action taken by an encoder :
+      int index;                                    //The index of the action (the same as returned by readAll)
+      int encoderId;                                //The encoder that took the action
+      int action;                                   //1 = CW, -1 = CCW, 9 = pressed, 10 = released, 11 = long press
+    };
+    struct Config {                               //The attributes of an encoder that never change (see addEncoder) :
+      byte type;                                    //2 = 2 steps per detent, 4 = 4 steps per detent
+      byte pin;                                     //Arduino's pin on which the encoder's common pin is attached (or line of the strobe device)
+      byte modes;                                   //The number of modes this encoder can take
+      int indexE;                                   //The index to return when an action is taken by the encoder
+      int indexS;                                   //The index to return if the encoder's switch has been pressed
+      int indexR;                                   //The index to return if the encoder's switch has been released
+      int indexL;                                   //The index to return if the encoder's switch is held (long press)
+    };
+#if CBE_STATS
+    struct Stats {                                //What happened since the last resetStats() :
+      unsigned long reads;                          //The readAll() calls that read encoders
+      unsigned long readMax;                        //The longest of them (in microseconds)
+      unsigned long readHistogram[CBE_STATS_BUCKETS]; //Bucket n : the calls under (16 << n) microseconds, the last one : all the others
+      unsigned long unsettled;                      //Samples where a debounce counter had not reached it's bus (bouncing contacts)
+      unsigned long illegal;                        //Transitions where both A and B changed (a state was missed)
+      unsigned long reversed;                       //Steps taken back before a click was completed (the knob went back)
+      unsigned long focusSwitches;                  //Encoders that joined the set of active encoders
+      unsigned long timeouts;                       //Encoders that left it after "resetChronoAfter"
+      unsigned long switchHeld;                     //Time the switches were held down (in milliseconds)
+    };
+#endif
     //Methods
-    CommonBusEncoders(int pinA, int pinB, int pinS, int count);                              //Constructor
+    CommonBusEncoders(int pinA, int pinB, int pinS, int count, CommonBusStrobe *strobe = NULL, Layout = Layout()); //Constructor
+    CommonBusEncoders(const byte *pinsA, const byte *pinsB, const byte *pinsS, int banks, int count, CommonBusStrobe *strobe = NULL, Layout = Layout()); //Constructor (several banks)
+    ~CommonBusEncoders();                                                                    //Destructor
     void addEncoder(int encoderId, int type, int pin, int modes, int indexE, int indexS);    //Add an encoder
     void resetChronoAfter(int aDelay);                                                       //Adjust encoder's priority timeout
     int readAll();                                                                           //Read all encoders
-    void setDebounce(int w);                                                                 //Debounce reads (1..32)
+    void setDebounce(int w);                                                                 //Debounce reads of each encoder (1..32, 4 by default; was samples back to back)
+    void setSettle(int us);                                                                  //Adjust the delay between enabling an encoder and reading it
+    void setSwitchIndexes(int encoderId, int indexR, int indexL);                            //Indexes for switch release and long press
+    void setLongPress(unsigned long aDelay);                                                 //Adjust the long press delay (0..65535ms)
     bool focussed();
+    void setSweep(int perCall);                                                              //Idle encoders read per readAll() while some are active
+    void setFullScan(bool on);                                                               //Read every encoder on every readAll()
+    void scan();                                                                             //Read every encoder once and queue their events
+    void tick();                                                                             //Read the next encoder and queue it's events (from a timer)
+    void setBackground(bool on);                                                             //readAll() only takes from the queue filled by tick()
+    bool poll(Event &e);                                                                     //Take the oldest event from the queue
+    int readEvents(Event *buf, int n);                                                       //Take up to n events from the queue
+    int pending();                                                                           //Number of events in the queue
+    unsigned long overflows();                                                               //Number of events lost because the queue was full
+    unsigned int memoryUsed();                                                               //Bytes of RAM used by this bank of encoders
+#if CBE_STATS
+    void stats(Stats &s);                                                                    //Copy of the statistics
+    unsigned int clicks(int encoderId);                                                      //Clicks of an encoder
+    void resetStats();                                                                       //Start the statistics over
+    void dumpStats(Print &out);                                                              //Write the statistics in binary
+#endif
+
+  protected:
+    CommonBusEncoders(int pinA, int pinB, int pinS, int count, const Config *table, byte *storage, CommonBusStrobe *strobe, Layout = Layout()); //Constructor (StaticCommonBusEncoders)
+    template <int N> friend class StaticCommonBusStorage;                                   //Sizes it's storage with storageSize()
+    static constexpr unsigned int storageSize(int count) {                                  //Bytes of RAM needed for the state of "count" encoders
+      return count * (CBE_STROBE_BYTES + CBE_STATE_BYTES + CBE_STATS_BYTES);
+    }
     
   private:
     //Methods
-    int debounce(int i);                          //Generic switch debounce routine
-    int readEncoder4(int i);                      //Read an encoder with 4 steps per detent
-    int readEncoder2(int i) ;                     //Read an encoder with 2 steps per detent
-    bool switchPressed(int i);                    //Confirm that an encoder's switch has been pressed
+    void begin(int pinA, int pinB, int pinS, int count, byte *storage); //Attach the busses and lay out the encoders table
+    void beginBanks(const byte *pinsA, const byte *pinsB, const byte *pinsS, int banks, byte *storage); //Attach the busses of the other banks
+    void attach(int i, int pin);                  //Put an encoder's common pin in OUTPUT mode and HIGH
+    static constexpr unsigned int configSize(int count) { //Bytes of RAM for the attributes of "count" encoders, rounded up so that the state that follows is aligned
+      return (count * sizeof(Config) + alignof(void *) - 1) & ~(alignof(void *) - 1);
+    }
+    Config config(int i);                         //The attributes of an encoder (from RAM or from PROGMEM)
+    byte readBusses();                            //Sample busses A, B and S at once
+    void readLanes(byte &a, byte &b, byte &s);    //Sample busses A, B and S of every bank at once (one bit per bank)
+    byte debounce(int i, byte sample);            //Debounce an encoder's busses A, B and S, one sample at a time
+    int readQuadrature(int i, byte type, byte sample); //Decode the rotation of an encoder (2 or 4 steps per detent)
+    int readSwitch(int i, byte modes, byte sample); //Advance the state of an encoder's switch (pressed, released, long press)
+    void strobe(int i, byte pin, int level);      //Drive an encoder's common pin LOW (enable) or HIGH (disable)
 		int readEncoder(int i);                       //Read a specific encoder (whatever the type)
-    int getIndex(int i);                          //Get the index of the action taken by an encoder (CW, CCW or switch pressed)
+    int getIndex(int i, int rotation);            //Get the index of the action taken by an encoder (CW, CCW or switch pressed)
+    void scanEncoder(int i);                      //Read an encoder and queue it's event
+    void scanBanks(int s);                        //Read the encoders of every bank on common pin "s" and queue their events
+    void scanSlot(int s);                         //Read the encoders on common pin "s" (one per bank) and queue their events
+    void sweep(int n);                            //Read the next "n" encoders that are not active
+    bool isMoving(byte before, byte after);       //Did an encoder's busses move between two of it's states
+    bool isHot(int i);                            //Is an encoder in the set of active encoders
+    void touch(int i);                            //Put an encoder in the set of active encoders
+    void expireHot();                             //Remove the encoders that are no longer active from the set
+    int nextHot();                                //The next active encoder to be read by tick()
+    void queue(int i, int rotation, int index);   //Add an event to the queue
+#if CBE_STATS
+    void countRead(unsigned long spent);          //Count a readAll() call in the statistics
+    void countHeld(int i);                        //Count the time an encoder's switch was held in the statistics
+#endif
 		//Attributes
     int MYpinA;                                   //Arduino's pin where the Bus A is attached
     int MYpinB;                                   //Arduino's pin where the Bus B is attached
     int MYpinS;                                   //Arduino's pin where the Bus with the switches is attached
     int MYcount;                                  //The number of encoders attached to the busses
-    unsigned long MYchrono;                       //Used to timeout an encoder's priority
+    byte MYbanks = 1;                             //The number of sets of busses (see the Constructor with several banks)
+    int MYslots;                                  //The number of common pins (count / banks, rounded up)
+    const byte *MYpinsA = NULL;                   //Arduino's pins of the Bus A of each bank (NULL with a single bank)
+    const byte *MYpinsB = NULL;                   //Arduino's pins of the Bus B of each bank
+    const byte *MYpinsS = NULL;                   //Arduino's pins of the Bus S of each bank
+    CommonBusStrobe *MYstrobe;                    //The device driving the common pins (NULL : Arduino pins)
+#if defined(__AVR__)
+    volatile uint8_t *MYregA;                     //Input register of the port where Bus A is attached
+    volatile uint8_t *MYregB;                     //Input register of the port where Bus B is attached
+    volatile uint8_t *MYregS;                     //Input register of the port where Bus S is attached
+    uint8_t MYmaskA;                              //Bit of Bus A in it's input register
+    uint8_t MYmaskB;                              //Bit of Bus B in it's input register
+    uint8_t MYmaskS;                              //Bit of Bus S in it's input register
+    bool MYsamePort;                              //All three busses are on the same port (one read per sample)
+    byte MYlaneShift;                             //Bit of bank 1 in the input registers (several banks)
+    bool MYlanesAligned = false;                  //Bank n uses bit (MYlaneShift + n - 1) of the A, B and S ports (one read per bus)
+#endif
     unsigned long MYactiveTimeLimit = 500;        //The encoder's priority timeout value (in milliseconds)
-		int debounceWidth = 16;                       //The number of conseccutive times a switch is read by the debouncer
-		unsigned long debounceDontCare = 0xffff0000;  //Mask to take into account the number of conseccutive times a switch is read by the debouncer
-    bool isFocussed;                              //A flag to specify thet a specific encoder is presently read
-    struct encoder {                              //For each encoder :
-      int type;                                     //2 = 2 steps per detent, 4 = 4 steps per detent
-      int pin;                                      //Arduino's pin on which the encoder's common pin is attached
-      int modes;                                    //The number of modes this encoder can take
-      int indexE;                                   //The index to return when an action is taken by the encoder
-      int indexS;                                   //The index to return if the encoder's switch has been pressed
-      int lastA;                                    //The last value (HIGH or LOW) that was read at pin A
-      int currentMode;                              //The current mode of the encoder
-    };
-  encoder *encoders;                         //A pointer to the table containing the encoder's attributes
+    unsigned int MYlongPress = 1000;              //The time a switch is held before a long press is reported (in milliseconds)
+		byte debounceWidth = 4;                       //The number of conseccutive reads that confirm a change of a bus
+    byte MYsettle = 5;                            //Time given to the busses to settle after an encoder is enabled (in microseconds)
+    bool MYfullScan = false;                      //Every encoder is read on every readAll() (see setFullScan)
+    bool MYbackground = false;                    //Encoders are read by tick() (see setBackground)
+    int MYhot[CBE_HOT_SIZE];                      //The common pins of the recently active encoders (-1 = free)
+    unsigned long MYhotTime[CBE_HOT_SIZE];        //When each of them was last active (millis)
+    byte MYhotNext = 0;                           //The next active encoder to be read by tick()
+    bool MYtickHot = false;                       //tick() alternates between active and idle encoders
+    int MYcursor = 0;                             //The common pin of the next idle encoders to be read
+    int MYsweep = 1;                              //The number of idle common pins read per readAll() while some are active
+    Event MYqueue[CBE_QUEUE_SIZE];                //The events waiting to be taken (ring buffer)
+    volatile byte MYhead = 0;                     //The events written in the queue (modulo 256, see queue)
+    volatile byte MYtail = 0;                     //The events taken from the queue (modulo 256)
+    volatile unsigned long MYoverflows = 0;       //Number of events lost because the queue was full
+    //The encoders table, one entry per encoder (encoderId 1 is entry 0) :
+    Config *MYconfig;                             //The attributes given by addEncoder (NULL if they are in PROGMEM)
+    const Config *MYtable;                        //The attributes in PROGMEM (StaticCommonBusEncoders)
+    byte *MYblock;                                //The memory allocated by the constructor (NULL for StaticCommonBusEncoders)
+#if defined(__AVR__)
+    volatile uint8_t **MYstrobeReg;               //Output register of the port where the common pin is attached
+    byte *MYstrobeMask;                           //Bit of the common pin in it's output register
+#endif
+    uint16_t *MYpressedAt;                        //When the switch was pressed (lower 16 bits of millis)
+#if CBE_STATS
+    uint16_t *MYclicks;                           //The clicks of the encoder (CW and CCW)
+#endif
+    byte *MYstate;                                //Last state of A and B (bits 0-1), debounced busses (bits 2-4), switch state (bits 5-6), settling (bit 7)
+    int8_t *MYsteps;                              //The valid steps counted since the last detent (+ CW, - CCW)
+    byte *MYintegrator;                           //Debounce counters of busses A, B and S (3 per encoder, 0..debounceWidth)
+    byte *MYmode;                                 //The current mode of the encoder
+    //With several banks, one entry per common pin, one bit per bank :
+    byte *MYlaneRest;                             //Debounced busses A, B and S (3 per common pin) (NULL with a single bank)
+    byte *MYlaneBusy;                             //The encoders that must be read even if their busses did not change
+    byte *MYlaneActive;                           //The encoders that were active since the common pin joined the set of active encoders
+#if CBE_STATS
+    Stats MYstats;                                //The statistics (see Stats)
+#endif
+};
+
+//StaticCommonBusStorage==========================================================================
+//The state of the N encoders of a StaticCommonBusEncoders<N>
+//It is the first base class, so it is constructed before CommonBusEncoders lays out the state in it
+//------------------------------------------------------------------------------------------------
+template <int N>
+class StaticCommonBusStorage
+{
+  protected:
+    alignas(void *) byte MYstorage[CommonBusEncoders::storageSize(N)]; //The state of the N encoders
+};
+
+//StaticCommonBusEncoders=========================================================================
+//A bank of N encoders that allocates no memory :
+//The attributes of the encoders are read from a table in PROGMEM (flash), so they use no RAM
+//The state of the encoders is sized when the sketch is compiled
+//Example :
+//  const CommonBusEncoders::Config table[2] PROGMEM = {
+//    //type, pin, modes, indexE, indexS, indexR, indexL
+//    {    2,  22,     1,    100,      0,      0,      0},
+//    {    2,  23,     1,    200,    300,      0,      0}
+//  };
+//  StaticCommonBusEncoders<2> encoders(34, 35, 36, table);
+//------------------------------------------------------------------------------------------------
+template <int N>
+class StaticCommonBusEncoders : private StaticCommonBusStorage<N>, public CommonBusEncoders
+{
+  public:
+    StaticCommonBusEncoders(int pinA, int pinB, int pinS, const Config *table, CommonBusStrobe *strobe = NULL) :
+      CommonBusEncoders(pinA, pinB, pinS, N, table, StaticCommonBusStorage<N>::MYstorage, strobe) {}
 };
 
 #endif;
@@ -0,0 +1,83 @@
+/*
+  MCP23017Strobe.h
+  Released into the public domain.
+
+  Drives the encoders' common pins from up to 8 MCP23017 expanders on the I2C bus (16 common pins per chip)
+  Line 0 is GPA0 of the first chip, line 8 is GPB0, line 16 is GPA0 of the second chip...
+  Call begin() in setup(), then give the object to the CommonBusEncoders constructor :
+    MCP23017Strobe strobes(0x20, 4);                                //64 common pins
+    CommonBusEncoders encoders(34, 35, 36, 64, &strobes);
+  The "pin" given to addEncoder is then the line of the encoder's common pin
+  The Wire library relies on interrupts, so tick() can not be called from an interrupt with this device
+*/
+
+#ifndef MCP23017Strobe_h
+#define MCP23017Strobe_h
+
+#include "Arduino.h"
+#include <Wire.h>
+#include "CommonBusEncoders.h"
+
+class MCP23017Strobe : public CommonBusStrobe
+{
+  public:
+    //Constructor=====================================================================
+    //address : The I2C address of the first chip (0x20 when A2 A1 A0 are LOW)
+    //chips   : The number of chips (1..8), at consecutive addresses
+    //--------------------------------------------------------------------------------
+    MCP23017Strobe(byte address, int chips) {
+      MYaddress = address;
+      MYchips = chips;
+    }//Constructor--------------------------------------------------------------------
+
+    //begin===========================================================================
+    //Starts the I2C bus, then sets every output HIGH (disabled) before making them outputs
+    //--------------------------------------------------------------------------------
+    void begin() {
+      Wire.begin();
+      Wire.setClock(400000);
+      for (int chip = 0 ; chip < MYchips ; chip++) {
+        write(chip, OLATA, 0xff, 0xff);
+        write(chip, IODIRA, 0x00, 0x00);
+      }
+      MYchip = -1;
+    }//begin--------------------------------------------------------------------------
+
+    //select==========================================================================
+    //Writes both output latches of the chip of "line" in one transfer, with only "line" LOW
+    //If the previous line was on another chip, that chip's outputs are set HIGH first
+    //--------------------------------------------------------------------------------
+    void select(int line) {
+      int chip = (line >= 0) ? line / 16 : -1;
+      if (MYchip >= 0 && MYchip != chip) {                         //Disable the previous chip
+        write(MYchip, OLATA, 0xff, 0xff);
+        MYtransfers++;
+      }
+      if (chip >= 0) {
+        uint16_t bits = ~(1 << (line % 16));                       //Only the selected line LOW
+        write(chip, OLATA, bits & 0xff, bits >> 8);
+        MYtransfers++;
+      }
+      MYchip = chip;
+    }//select-------------------------------------------------------------------------
+
+  private:
+    enum { IODIRA = 0x00, OLATA = 0x14 };       //Registers (IOCON.BANK = 0, A and B are consecutive)
+
+    //write===========================================================================
+    //Writes two consecutive registers (A then B) of a chip
+    //--------------------------------------------------------------------------------
+    void write(int chip, byte reg, byte a, byte b) {
+      Wire.beginTransmission(MYaddress + chip);
+      Wire.write(reg);
+      Wire.write(a);
+      Wire.write(b);
+      Wire.endTransmission();
+    }//write--------------------------------------------------------------------------
+
+    byte MYaddress;                               //The I2C address of the first chip
+    int MYchips;                                  //The number of chips
+    int MYchip;                                   //The chip of the selected line (-1 : none)
+};
+
+#endif
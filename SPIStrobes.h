@@ -0,0 +1,136 @@
+/*
+  SPIStrobes.h
+  Released into the public domain.
+
+  Drives the encoders' common pins from devices on the SPI bus :
+    SPIShiftRegisterStrobe : a chain of 74HC595 shift registers (8 common pins per chip)
+    MCP23S17Strobe         : up to 8 MCP23S17 expanders sharing a chip select (16 common pins per chip)
+  Line 0 is the first output of the first chip, line 8 (or 16) the first output of the second chip...
+  Call begin() in setup(), then give the object to the CommonBusEncoders constructor :
+    SPIShiftRegisterStrobe strobes(10, 8);                          //64 common pins
+    CommonBusEncoders encoders(34, 35, 36, 64, &strobes);
+  The "pin" given to addEncoder is then the line of the encoder's common pin
+  If tick() is called from an interrupt, the sketch must not use the SPI bus outside of it
+  (see SPI.usingInterrupt())
+*/
+
+#ifndef SPIStrobes_h
+#define SPIStrobes_h
+
+#include "Arduino.h"
+#include <SPI.h>
+#include "CommonBusEncoders.h"
+
+class SPIShiftRegisterStrobe : public CommonBusStrobe
+{
+  public:
+    //Constructor=====================================================================
+    //latchPin : Arduino's pin connected to STCP (pin 12) of every chip
+    //chips    : The number of chips in the chain
+    //DS (pin 14) of the first chip is connected to MOSI and SHCP (pin 11) of every chip to SCK
+    //--------------------------------------------------------------------------------
+    SPIShiftRegisterStrobe(int latchPin, int chips) {
+      MYlatchPin = latchPin;
+      MYchips = chips;
+    }//Constructor--------------------------------------------------------------------
+
+    //begin===========================================================================
+    //Starts the SPI bus and disables every common pin
+    //--------------------------------------------------------------------------------
+    void begin() {
+      pinMode(MYlatchPin, OUTPUT);
+      digitalWrite(MYlatchPin, HIGH);
+      SPI.begin();
+      select(-1);
+    }//begin--------------------------------------------------------------------------
+
+    //select==========================================================================
+    //Shifts the whole chain (the last chip first), with only "line" LOW, then latches it
+    //--------------------------------------------------------------------------------
+    void select(int line) {
+      SPI.beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
+      digitalWrite(MYlatchPin, LOW);
+      for (int chip = MYchips - 1 ; chip >= 0 ; chip--) {
+        byte bits = 0xff;                                          //Every common pin HIGH (disabled)
+        if (line >= 0 && line / 8 == chip) bits &= ~(1 << (line % 8)); //But the selected one
+        SPI.transfer(bits);
+      }
+      digitalWrite(MYlatchPin, HIGH);                              //All outputs change at once
+      SPI.endTransaction();
+      MYtransfers++;
+    }//select-------------------------------------------------------------------------
+
+  private:
+    int MYlatchPin;                               //Arduino's pin connected to STCP
+    int MYchips;                                  //The number of chips in the chain
+};
+
+class MCP23S17Strobe : public CommonBusStrobe
+{
+  public:
+    //Constructor=====================================================================
+    //csPin : Arduino's pin connected to CS of every chip
+    //chips : The number of chips (1..8), their hardware addresses (A2 A1 A0) going from 0 to chips - 1
+    //--------------------------------------------------------------------------------
+    MCP23S17Strobe(int csPin, int chips) {
+      MYcsPin = csPin;
+      MYchips = chips;
+    }//Constructor--------------------------------------------------------------------
+
+    //begin===========================================================================
+    //Starts the SPI bus, enables the hardware addresses,
+    //then sets every output HIGH (disabled) before making them outputs
+    //--------------------------------------------------------------------------------
+    void begin() {
+      pinMode(MYcsPin, OUTPUT);
+      digitalWrite(MYcsPin, HIGH);
+      SPI.begin();
+      write(0, IOCON, HAEN, HAEN);                                 //Every chip answers to address 0 until HAEN is set
+      for (int chip = 0 ; chip < MYchips ; chip++) {
+        write(chip, OLATA, 0xff, 0xff);
+        write(chip, IODIRA, 0x00, 0x00);
+      }
+      MYchip = -1;
+    }//begin--------------------------------------------------------------------------
+
+    //select==========================================================================
+    //Writes both output latches of the chip of "line" in one transfer, with only "line" LOW
+    //If the previous line was on another chip, that chip's outputs are set HIGH first
+    //--------------------------------------------------------------------------------
+    void select(int line) {
+      int chip = (line >= 0) ? line / 16 : -1;
+      if (MYchip >= 0 && MYchip != chip) {                         //Disable the previous chip
+        write(MYchip, OLATA, 0xff, 0xff);
+        MYtransfers++;
+      }
+      if (chip >= 0) {
+        uint16_t bits = ~(1 << (line % 16));                       //Only the selected line LOW
+        write(chip, OLATA, bits & 0xff, bits >> 8);
+        MYtransfers++;
+      }
+      MYchip = chip;
+    }//select-------------------------------------------------------------------------
+
+  private:
+    enum { IODIRA = 0x00, IOCON = 0x0A, OLATA = 0x14, HAEN = 0x08 }; //Registers (IOCON.BANK = 0)
+
+    //write===========================================================================
+    //Writes two consecutive registers (A then B) of a chip
+    //--------------------------------------------------------------------------------
+    void write(int chip, byte reg, byte a, byte b) {
+      SPI.beginTransaction(SPISettings(10000000, MSBFIRST, SPI_MODE0));
+      digitalWrite(MYcsPin, LOW);
+      SPI.transfer(0x40 | (chip << 1));                            //Write opcode
+      SPI.transfer(reg);
+      SPI.transfer(a);
+      SPI.transfer(b);
+      digitalWrite(MYcsPin, HIGH);
+      SPI.endTransaction();
+    }//write--------------------------------------------------------------------------
+
+    int MYcsPin;                                  //Arduino's pin connected to CS
+    int MYchips;                                  //The number of chips
+    int MYchip;                                   //The chip of the selected line (-1 : none)
+};
+
+#endif
@@ -0,0 +1,68 @@
+/*
+  ShiftRegisterStrobe.h
+  Released into the public domain.
+
+  Drives the encoders' common pins from a chain of 74HC595 shift registers (bit-banged).
+  Three Arduino pins (data, clock and latch) drive 8 common pins per chip in the chain.
+  Line 0 is Q0 of the first chip (the one wired to the Arduino), line 8 is Q0 of the second chip...
+  Call begin() in setup(), then give the object to the CommonBusEncoders constructor :
+    ShiftRegisterStrobe strobes(8, 9, 10, 8);                       //64 common pins
+    CommonBusEncoders encoders(34, 35, 36, 64, &strobes);
+  The "pin" given to addEncoder is then the line of the encoder's common pin
+  See SPIStrobes.h for a faster chain on the SPI bus
+*/
+
+#ifndef ShiftRegisterStrobe_h
+#define ShiftRegisterStrobe_h
+
+#include "Arduino.h"
+#include "CommonBusEncoders.h"
+
+class ShiftRegisterStrobe : public CommonBusStrobe
+{
+  public:
+    //Constructor=====================================================================
+    //dataPin  : Arduino's pin connected to DS (pin 14) of the first chip
+    //clockPin : Arduino's pin connected to SHCP (pin 11) of every chip
+    //latchPin : Arduino's pin connected to STCP (pin 12) of every chip
+    //chips    : The number of chips in the chain
+    //--------------------------------------------------------------------------------
+    ShiftRegisterStrobe(int dataPin, int clockPin, int latchPin, int chips) {
+      MYdataPin = dataPin;
+      MYclockPin = clockPin;
+      MYlatchPin = latchPin;
+      MYchips = chips;
+    }//Constructor--------------------------------------------------------------------
+
+    //begin===========================================================================
+    //Puts the pins in OUTPUT mode and disables every common pin
+    //--------------------------------------------------------------------------------
+    void begin() {
+      pinMode(MYdataPin, OUTPUT);
+      pinMode(MYclockPin, OUTPUT);
+      pinMode(MYlatchPin, OUTPUT);
+      select(-1);
+    }//begin--------------------------------------------------------------------------
+
+    //select==========================================================================
+    //Shifts the whole chain (the last chip first), with only "line" LOW, then latches it
+    //--------------------------------------------------------------------------------
+    void select(int line) {
+      digitalWrite(MYlatchPin, LOW);
+      for (int chip = MYchips - 1 ; chip >= 0 ; chip--) {
+        byte bits = 0xff;                                          //Every common pin HIGH (disabled)
+        if (line >= 0 && line / 8 == chip) bits &= ~(1 << (line % 8)); //But the selected one
+        shiftOut(MYdataPin, MYclockPin, MSBFIRST, bits);
+      }
+      digitalWrite(MYlatchPin, HIGH);                              //All outputs change at once
+      MYtransfers++;
+    }//select-------------------------------------------------------------------------
+
+  private:
+    int MYdataPin;                                //Arduino's pin connected to DS of the first chip
+    int MYclockPin;                               //Arduino's pin connected to SHCP
+    int MYlatchPin;                               //Arduino's pin connected to STCP
+    int MYchips;                                  //The number of chips in the chain
+};
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ *  Background.ino
+ *  This code is on public domain
+ *  
+ *  This sketch shows how to read the encoders in the background, from a timer interrupt
+ *  Timer2 of an Arduino Mega (or Uno) calls encoders.tick() TICK_HZ times per second
+ *  Each tick reads one encoder and queues it's action
+ *  loop() only takes the actions from the queue, so it can be as slow as it needs to be
+ *  (the delay() below stands for an LCD or a serial link that takes time)
+ *  Once per second, the sketch prints :
+ *    The number of ticks, and the shortest and longest time between two ticks (jitter)
+ *    The longest time spent in a tick
+ *    The number of actions taken from the queue and the number lost because it was full
+ */
+
+//INCLUDE THE LIBRARY================
+#include <CommonBusEncoders.h>
+
+//CREATE THE OBJECT (ENCODER BANK)=================
+CommonBusEncoders encoders(34, 35, 36, 2);
+
+//Each encoder is noticed within 2 x count ticks, and a change of a bus is confirmed after "width"
+//reads (see setDebounce) : the worst case is width x 2 x count ticks (see tick() in CommonBusEncoders.cpp)
+#define TICK_HZ 2000                       //1000 to 10000 ticks per second
+
+//INITIALISE THE VARIABLES===================================================
+volatile unsigned long ticks = 0;          //Number of ticks
+volatile unsigned long lastTick = 0;       //When the last tick started (micros)
+volatile unsigned long minGap = 0xffffffff;//Shortest time between two ticks
+volatile unsigned long maxGap = 0;         //Longest time between two ticks
+volatile unsigned long maxTick = 0;        //Longest time spent in a tick
+unsigned long actions = 0;                 //Number of actions taken from the queue
+unsigned long chrono = 0;                  //For the report every second
+
+//Timer2 interrupt=================================================================
+//Reads the next encoder and measures the time between ticks
+//---------------------------------------------------------------------------------
+ISR(TIMER2_COMPA_vect) {
+  unsigned long start = micros();
+  if (ticks > 0) {
+    unsigned long gap = start - lastTick;
+    if (gap < minGap) minGap = gap;
+    if (gap > maxGap) maxGap = gap;
+  }
+  lastTick = start;
+  encoders.tick();                                             //Read the next encoder
+  unsigned long spent = micros() - start;
+  if (spent > maxTick) maxTick = spent;
+  ticks++;
+}//Timer2 interrupt----------------------------------------------------------------
+
+//setup======================================================================================
+//Initialise encoders
+//Start Timer2 in CTC mode : 16MHz / 64 = 250kHz, divided by TICK_HZ
+//-------------------------------------------------------------------------------------------
+void setup() {
+  encoders.addEncoder(1, 2, 22, 1, 100,   0);
+  encoders.addEncoder(2, 2, 23, 1, 200, 300);
+  encoders.setBackground(true);                              //readAll() only takes from the queue
+  Serial.begin(115200);
+
+  noInterrupts();
+  TCCR2A = (1 << WGM21);                                     //CTC mode
+  TCCR2B = (1 << CS22);                                      //Prescaler 64
+  OCR2A = (F_CPU / 64 / TICK_HZ) - 1;                        //Ticks per second
+  TIMSK2 = (1 << OCIE2A);                                    //Interrupt on compare match
+  interrupts();
+}//setup------------------------------------------------------------------------------------
+
+//loop==========================================================================
+//Take the actions from the queue and print them
+//Report the ticks every second
+//------------------------------------------------------------------------------
+void loop() {
+  int index;
+  while ((index = encoders.readAll()) != 0) {              //Take every action waiting
+    Serial.println(index);
+    actions++;
+  }
+  delay(20);                                               //Slow work : the encoders are still read
+
+  if (millis() - chrono >= 1000) {
+    chrono = millis();
+    noInterrupts();
+    unsigned long t = ticks, lo = minGap, hi = maxGap, spent = maxTick;
+    ticks = 0; minGap = 0xffffffff; maxGap = 0; maxTick = 0;
+    interrupts();
+    Serial.print("ticks/s: ");   Serial.print(t);
+    Serial.print(" gap us: ");   Serial.print(lo); Serial.print(".."); Serial.print(hi);
+    Serial.print(" tick us: ");  Serial.print(spent);
+    Serial.print(" actions: ");  Serial.print(actions);
+    Serial.print(" lost: ");     Serial.println(encoders.overflows());
+  }
+}//loop-------------------------------------------------------------------------
@@ -0,0 +1,48 @@
+/*
+ *  Banks.ino
+ *  This code is on public domain
+ *  
+ *  This sketch reads 64 encoders on an Arduino Mega, in 8 banks of 8 encoders
+ *  Each bank has it's own busses A, B and S, and the 8 common pins are shared by the banks :
+ *  enabling a common pin enables one encoder in every bank, and the 8 of them are read at once
+ *    Bank n : Bus A on pin 21 + n (PORTA), Bus B on pin 38 - n (PORTC), Bus S on pin 50 - n (PORTL)
+ *    Common pins : 2 to 9
+ *  Encoders 1 to 8 are on common pin 2 (banks 1 to 8), encoders 9 to 16 on common pin 3, and so on
+ *  Every second, the sketch prints the time taken by scan() to read the 64 encoders
+ */
+
+//INCLUDE THE LIBRARY================
+#include <CommonBusEncoders.h>
+
+#define BANKS 8                            //Sets of busses
+#define COMMONS 8                          //Common pins, shared by the banks
+#define ENCODERS (BANKS * COMMONS)
+
+const byte pinsA[BANKS] = {22, 23, 24, 25, 26, 27, 28, 29};  //PA0..PA7
+const byte pinsB[BANKS] = {37, 36, 35, 34, 33, 32, 31, 30};  //PC0..PC7
+const byte pinsS[BANKS] = {49, 48, 47, 46, 45, 44, 43, 42};  //PL0..PL7
+
+CommonBusEncoders encoders(pinsA, pinsB, pinsS, BANKS, ENCODERS);
+
+unsigned long lastReport = 0;
+
+void setup() {
+  for (int n = 1 ; n <= ENCODERS ; n++) {
+    //encoderId, type, common pin, modes, indexE, indexS
+    encoders.addEncoder(n, 2, 2 + (n - 1) / BANKS, 1, n * 10, n * 10 + 5);
+  }
+  Serial.begin(9600);
+}
+
+void loop() {
+  int index = encoders.readAll();
+  if (index != 0) Serial.println(index);
+  if (millis() - lastReport >= 1000) {
+    lastReport = millis();
+    unsigned long start = micros();
+    encoders.scan();
+    unsigned long spent = micros() - start;
+    Serial.print(F("scan us : "));
+    Serial.println(spent);
+  }
+}
@@ -3,7 +3,7 @@
 CommonBusEncoders encoders(34, 35, 36, 2);
 
 void setup() {
-  encoders.setDebounce(16);
+  encoders.setDebounce(4);
   encoders.resetChronoAfter(1000);
   encoders.addEncoder(1, 2, 22, 1, 100,   0);
   encoders.addEncoder(2, 2, 23, 1, 200, 300);
@@ -0,0 +1,71 @@
+/*
+ *  Benchmark.ino
+ *  This code is on public domain
+ *  
+ *  This sketch measures the time taken to read banks of 1 to MAX_ENCODERS encoders
+ *  No encoder needs to be attached : every encoder of a bank uses the same common pin (COMMON),
+ *  so the busses and that pin only need to be left unconnected (the busses are pulled up)
+ *  With no encoder turned, readAll() reads every encoder of the bank on every call,
+ *  which is the longest it ever takes in the default mode
+ *  For each bank, the sketch prints :
+ *    N      : the number of encoders in the bank
+ *    mode   : readAll (default), fullScan (setFullScan) or tick (one tick() per call)
+ *    min/avg/max us : the time taken by one call
+ *    scans/s : the number of times per second every encoder of the bank is read
+ *    RAM     : the bytes of RAM used by the bank (memoryUsed)
+ *  Run it before and after a change to the library to compare
+ */
+
+//INCLUDE THE LIBRARY================
+#include <CommonBusEncoders.h>
+
+#define PIN_A 34                           //Bus A
+#define PIN_B 35                           //Bus B
+#define PIN_S 36                           //Bus S
+#define COMMON 22                          //Common pin shared by every encoder of the bank
+#define MAX_ENCODERS 128                   //256 on boards with more SRAM than a Mega
+#define CALLS 200                          //Calls measured for each bank and mode
+
+//measure=====================================================================================
+//Calls readAll() (or tick()) CALLS times and prints the time taken by a call
+//"perScan" is the number of calls needed to read every encoder of the bank once
+//--------------------------------------------------------------------------------------------
+void measure(CommonBusEncoders &bank, int n, const char *mode, bool ticks, int perScan) {
+  unsigned long lo = 0xffffffff, hi = 0, total = 0;
+  for (int i = 0 ; i < CALLS ; i++) {
+    unsigned long start = micros();
+    if (ticks) bank.tick();
+    else       bank.readAll();
+    unsigned long spent = micros() - start;
+    if (spent < lo) lo = spent;
+    if (spent > hi) hi = spent;
+    total += spent;
+  }
+  Serial.print(n);                          Serial.print('\t');
+  Serial.print(mode);                       Serial.print('\t');
+  Serial.print(lo);                         Serial.print('\t');
+  Serial.print(total / CALLS);              Serial.print('\t');
+  Serial.print(hi);                         Serial.print('\t');
+  Serial.print(1000000.0 * CALLS / total / perScan); Serial.print('\t');
+  Serial.println(bank.memoryUsed());
+}//measure------------------------------------------------------------------------------------
+
+//setup======================================================================================
+//Measure banks of 1, 2, 4, 8... MAX_ENCODERS encoders
+//-------------------------------------------------------------------------------------------
+void setup() {
+  Serial.begin(115200);
+  Serial.println("N\tmode\tmin us\tavg us\tmax us\tscans/s\tRAM");
+  for (int n = 1 ; n <= MAX_ENCODERS ; n *= 2) {
+    CommonBusEncoders *bank = new CommonBusEncoders(PIN_A, PIN_B, PIN_S, n);
+    for (int i = 1 ; i <= n ; i++) bank->addEncoder(i, 4, COMMON, 1, 100 + i * 2, 0);
+    measure(*bank, n, "readAll",  false, 1);
+    bank->setFullScan(true);
+    measure(*bank, n, "fullScan", false, 1);
+    measure(*bank, n, "tick",     true,  n);
+    delete bank;
+  }
+}//setup------------------------------------------------------------------------------------
+
+void loop() {
+}
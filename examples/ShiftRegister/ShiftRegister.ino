@@ -0,0 +1,51 @@
+/*
+ *  ShiftRegister.ino
+ *  This code is on public domain
+ *  
+ *  This sketch reads 64 encoders with 6 pins :
+ *    the 3 busses, and a chain of 8 74HC595 shift registers on the SPI bus driving the 64 common pins
+ *    (MOSI to DS of the first chip, SCK to SHCP of every chip, LATCH to STCP of every chip)
+ *  Encoder n has it's common pin on line n - 1 : Q0 of the first chip for encoder 1,
+ *  Q0 of the second chip for encoder 9...
+ *  Every second, the sketch prints the number of transfers made on the SPI bus (one per encoder read)
+ *  To use a bit-banged chain instead, include ShiftRegisterStrobe.h and replace "strobes" with :
+ *    ShiftRegisterStrobe strobes(DATA, CLOCK, LATCH, CHIPS);
+ */
+
+//INCLUDE THE LIBRARY================
+#include <CommonBusEncoders.h>
+#include <SPIStrobes.h>
+
+#define PIN_A 34                           //Bus A
+#define PIN_B 35                           //Bus B
+#define PIN_S 36                           //Bus S
+#define LATCH 10                           //STCP of every chip
+#define CHIPS 8                            //Chips in the chain
+#define ENCODERS (CHIPS * 8)               //One encoder per output
+
+SPIShiftRegisterStrobe strobes(LATCH, CHIPS);
+CommonBusEncoders encoders(PIN_A, PIN_B, PIN_S, ENCODERS, &strobes);
+
+unsigned long lastReport = 0;
+unsigned long lastTransfers = 0;
+
+void setup() {
+  strobes.begin();
+  for (int n = 1 ; n <= ENCODERS ; n++) {
+    //encoderId, type, line, modes, indexE, indexS
+    encoders.addEncoder(n, 2, n - 1, 1, n * 10, n * 10 + 5);
+  }
+  Serial.begin(9600);
+}
+
+void loop() {
+  int index = encoders.readAll();
+  if (index != 0) Serial.println(index);
+  if (millis() - lastReport >= 1000) {
+    lastReport = millis();
+    unsigned long transfers = strobes.transfers();
+    Serial.print(F("transfers/s : "));
+    Serial.println(transfers - lastTransfers);
+    lastTransfers = transfers;
+  }
+}
@@ -0,0 +1,70 @@
+/*
+  Arduino.h (host)
+  Released into the public domain.
+
+  Stands in for the Arduino core so that the library compiles unchanged on a PC (see the Makefile)
+  The pins and the clock are those of the simulated board (see Board.h)
+  Compiled with -D__AVR__, it also has the port registers of an AVR board (8 pins per port),
+  so that the library reads the busses and drives the common pins through them
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define memcpy_P memcpy
+#define F(s) (s)
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+template <class T, class U> inline auto min(const T &a, const U &b) -> decltype(a < b ? a : b) { return a < b ? a : b; }
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t value);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+#if defined(__AVR__)
+extern uint8_t SREG;                            //Bit 7 : interrupts enabled
+extern volatile uint8_t boardInputs[];          //Input register of each port
+extern volatile uint8_t boardOutputs[];         //Output register of each port
+inline void cli() { SREG &= 0x7f; }
+inline void sei() { SREG |= 0x80; }
+inline void noInterrupts() { cli(); }
+inline void interrupts() { sei(); }
+#define digitalPinToPort(p) ((p) / 8 + 1)       //Port 0 is NOT_A_PORT
+#define digitalPinToBitMask(p) (1 << ((p) % 8))
+#define portInputRegister(port) (&boardInputs[port])
+#define portOutputRegister(port) (&boardOutputs[port])
+#else
+inline void noInterrupts() {}
+inline void interrupts() {}
+#endif
+
+class Print
+{
+  public:
+    virtual size_t write(uint8_t b) = 0;
+    size_t write(const uint8_t *buf, size_t n) { for (size_t i = 0 ; i < n ; i++) write(buf[i]); return n; }
+    virtual ~Print() {}
+};
+
+#endif
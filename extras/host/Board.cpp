@@ -0,0 +1,167 @@
+/*
+  Board.cpp
+  Released into the public domain.
+
+  See Board.h
+*/
+
+#include "Board.h"
+#include "SPI.h"
+#include "Wire.h"
+
+#define BOARD_PORTS (BOARD_PINS / 8 + 1)
+
+#if defined(__AVR__)
+uint8_t SREG;
+volatile uint8_t boardInputs[BOARD_PORTS];
+volatile uint8_t boardOutputs[BOARD_PORTS];
+#endif
+SPIClass SPI;
+TwoWire Wire;
+
+namespace Board {
+  unsigned long now;
+  unsigned long reads;
+  unsigned long writes;
+  unsigned int readCost = 4;
+  unsigned int writeCost = 5;
+
+  static byte pinModes[BOARD_PINS];               //pinMode() of each Arduino pin
+  static byte levels[BOARD_COMMONS];              //Level written to each common (pin or strobe line)
+  static Contacts *matrix[BOARD_COMMONS][BOARD_BANKS]; //The encoder on each common, in each bank
+  static int busBank[BOARD_PINS];                 //Bank of a bus pin (-1 : not a bus)
+  static byte busContact[BOARD_PINS];             //Contact that pulls that bus down (CLOSED_A, CLOSED_B or CLOSED_S)
+  static int lows[BOARD_COMMONS];                 //The commons driven LOW
+  static int lowCount;
+  static int busPins[BOARD_PINS];                 //The bus pins
+  static int busCount;
+#if defined(__AVR__)
+  static uint8_t driven[BOARD_PORTS];             //The output registers, as last driven to the pins
+#endif
+
+  //updateLow=====================================================================
+  //Keeps the list of the commons that are driven LOW
+  //------------------------------------------------------------------------------
+  static void updateLow(int common) {
+    bool low = levels[common] == LOW && (common >= STROBE_LINE || pinModes[common] == OUTPUT);
+    for (int n = 0 ; n < lowCount ; n++) {
+      if (lows[n] != common) continue;
+      if (!low) lows[n] = lows[--lowCount];
+      return;
+    }
+    if (low) lows[lowCount++] = common;
+  }//updateLow--------------------------------------------------------------------
+
+  void reset() {
+    now = reads = writes = 0;
+    memset(pinModes, INPUT, sizeof(pinModes));
+    memset(levels, HIGH, sizeof(levels));
+    memset(matrix, 0, sizeof(matrix));
+    for (int p = 0 ; p < BOARD_PINS ; p++) busBank[p] = -1;
+    lowCount = busCount = 0;
+#if defined(__AVR__)
+    memset((void *) boardInputs, 0xff, sizeof(boardInputs));
+    memset((void *) boardOutputs, 0xff, sizeof(boardOutputs));
+    memset(driven, 0xff, sizeof(driven));
+    SREG = 0x80;                                  //Interrupts enabled, as in loop()
+#endif
+    SPI.clear();
+    Wire.clear();
+  }
+
+  void advance(unsigned long us) {
+    now += us;
+  }
+
+  void busses(int bank, int pinA, int pinB, int pinS) {
+    busPins[busCount++] = pinA;
+    busPins[busCount++] = pinB;
+    busPins[busCount++] = pinS;
+    busBank[pinA] = busBank[pinB] = busBank[pinS] = bank;
+    busContact[pinA] = CLOSED_A;
+    busContact[pinB] = CLOSED_B;
+    busContact[pinS] = CLOSED_S;
+  }
+
+  void place(int common, int bank, Contacts *c) {
+    matrix[common][bank] = c;
+  }
+
+  void drive(int common, int level) {
+    levels[common] = level;
+    updateLow(common);
+  }
+
+  int level(int common) {
+    for (int n = 0 ; n < lowCount ; n++) if (lows[n] == common) return LOW;
+    return HIGH;
+  }
+
+  //bus===========================================================================
+  //The level of a bus pin : LOW if an enabled encoder of it's bank closes it's contact
+  //------------------------------------------------------------------------------
+  int bus(int pin) {
+    int bank = busBank[pin];
+    if (bank < 0) return HIGH;                    //Not a bus : pulled up
+    for (int n = 0 ; n < lowCount ; n++) {
+      Contacts *c = matrix[lows[n]][bank];
+      if (c != NULL && (c->closed(now) & busContact[pin])) return LOW;
+    }
+    return HIGH;
+  }
+
+#if defined(__AVR__)
+  //settle========================================================================
+  //Drives the common pins from the output registers, then samples every bus into the input registers
+  //------------------------------------------------------------------------------
+  static void settle() {
+    for (int port = 1 ; port < BOARD_PORTS ; port++) {
+      byte changed = boardOutputs[port] ^ driven[port];
+      if (changed == 0) continue;
+      for (int b = 0 ; b < 8 ; b++) if (changed & (1 << b)) drive((port - 1) * 8 + b, (boardOutputs[port] >> b) & 1);
+      driven[port] = boardOutputs[port];
+    }
+    for (int n = 0 ; n < busCount ; n++) {
+      int p = busPins[n];
+      volatile uint8_t &in = boardInputs[p / 8 + 1];
+      in = bus(p) ? (in | (1 << (p % 8))) : (in & ~(1 << (p % 8)));
+    }
+  }//settle-----------------------------------------------------------------------
+#endif
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  Board::pinModes[pin] = mode;
+  Board::updateLow(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  Board::writes++;
+  Board::now += Board::writeCost;
+  Board::drive(pin, level);
+#if defined(__AVR__)
+  volatile uint8_t &out = boardOutputs[pin / 8 + 1];
+  out = level ? (out | (1 << (pin % 8))) : (out & ~(1 << (pin % 8)));
+  Board::driven[pin / 8 + 1] = out;
+#endif
+}
+
+int digitalRead(uint8_t pin) {
+  Board::reads++;
+  Board::now += Board::readCost;
+  return Board::bus(pin);
+}
+
+void shiftOut(uint8_t, uint8_t, uint8_t, uint8_t) {
+  Board::now += 8 * 2 * Board::writeCost;
+}
+
+unsigned long millis() { return Board::now / 1000; }
+unsigned long micros() { return Board::now; }
+void delay(unsigned long ms) { Board::now += ms * 1000; }
+void delayMicroseconds(unsigned int us) {
+  Board::now += us;
+#if defined(__AVR__)
+  Board::settle();
+#endif
+}
@@ -0,0 +1,55 @@
+/*
+  Board.h
+  Released into the public domain.
+
+  The board simulated behind the host Arduino.h :
+    A virtual clock, advanced by delay(), delayMicroseconds() and by what each pin access costs on a Mega
+    A diode matrix : an encoder's contacts pull a bus LOW only while it's common pin is driven LOW
+  Common pins are Arduino pins (0..255) or lines of a strobe device (STROBE_LINE + line, see drive())
+  The encoders themselves are scripted with Knob (see Knob.h)
+  The SPI and I2C busses only log what is written on them (see SPI.h, Wire.h and BusLog.h)
+  With -D__AVR__, the port registers written by the library drive the common pins, and the busses are
+  sampled into the input registers when they are given time to settle (delayMicroseconds()).
+  Reading a port costs no virtual time, as it takes a single cycle
+*/
+
+#ifndef Board_h
+#define Board_h
+
+#include "Arduino.h"
+
+#define BOARD_PINS 256                    //Arduino pins of the simulated board
+#define STROBE_LINE 256                   //First common of a strobe device's lines
+#define BOARD_COMMONS 512                 //Arduino pins and strobe lines
+#define BOARD_BANKS 8                     //Sets of busses
+
+#define CLOSED_A 0x01                     //Contacts returned by Contacts::closed()
+#define CLOSED_B 0x02
+#define CLOSED_S 0x04
+
+//Contacts========================================================================
+//What an encoder's contacts do over time
+//--------------------------------------------------------------------------------
+class Contacts
+{
+  public:
+    virtual byte closed(unsigned long us) = 0;    //CLOSED_A, CLOSED_B and CLOSED_S bits at time "us"
+    virtual ~Contacts() {}
+};
+
+namespace Board {
+  extern unsigned long now;                       //Virtual time (microseconds)
+  extern unsigned long reads;                     //digitalRead() calls
+  extern unsigned long writes;                    //digitalWrite() calls
+  extern unsigned int readCost;                   //Virtual microseconds taken by a digitalRead() (about 4 on a Mega)
+  extern unsigned int writeCost;                  //Virtual microseconds taken by a digitalWrite() (about 5 on a Mega)
+
+  void reset();                                   //No encoder, every pin released, time 0
+  void advance(unsigned long us);                 //Let time pass
+  void busses(int bank, int pinA, int pinB, int pinS); //The pins of the busses of a bank
+  void place(int common, int bank, Contacts *c);  //An encoder on a common pin of a bank
+  void drive(int common, int level);              //Drive a common pin (used by strobe devices)
+  int level(int common);                          //The level a common pin is driven to (HIGH if not driven)
+}
+
+#endif
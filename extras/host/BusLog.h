@@ -0,0 +1,52 @@
+/*
+  BusLog.h
+  Released into the public domain.
+
+  The log of the transfers made on a bus of the simulated board (see SPI.h and Wire.h) :
+  nothing is sent anywhere, but tests can check what a strobe device wrote, transfer by transfer
+*/
+
+#ifndef BusLog_h
+#define BusLog_h
+
+#include "Arduino.h"
+
+#define BUS_LOG 8                                 //Transfers kept (the last ones)
+#define BUS_BYTES 16                              //Bytes kept per transfer
+
+//BusTransfer=====================================================================
+//A transaction (SPI) or a transmission (I2C)
+//--------------------------------------------------------------------------------
+struct BusTransfer {
+  uint8_t address;                                //The I2C address (0 on the SPI bus)
+  uint8_t bytes[BUS_BYTES];                       //The bytes written
+  uint8_t length;                                 //The number of bytes written
+};
+
+//BusLog==========================================================================
+//Counts the transfers since clear() and keeps the last BUS_LOG of them
+//--------------------------------------------------------------------------------
+class BusLog
+{
+  public:
+    unsigned long count = 0;                      //Transfers since clear()
+    unsigned long bytes = 0;                      //Bytes since clear()
+    void clear() { count = bytes = 0; }
+    const BusTransfer &at(unsigned long n) { return MYlog[n % BUS_LOG]; } //Transfer n (0 : the first since clear())
+    const BusTransfer &last() { return at(count - 1); }
+  protected:
+    void start(uint8_t address) {                 //A new transfer
+      BusTransfer &t = MYlog[count++ % BUS_LOG];
+      t.address = address;
+      t.length = 0;
+    }
+    void add(uint8_t b) {                         //A byte of the current transfer
+      BusTransfer &t = MYlog[(count - 1) % BUS_LOG];
+      if (t.length < BUS_BYTES) t.bytes[t.length++] = b;
+      bytes++;
+    }
+  private:
+    BusTransfer MYlog[BUS_LOG];
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*
+  Knob.cpp
+  Released into the public domain.
+
+  See Knob.h
+*/
+
+#include "Knob.h"
+
+//The states of A and B (A << 1 | B, HIGH when open) turning CW from a detent
+static const byte cw[4] = {3, 1, 0, 2};
+
+Knob::Knob(unsigned long seed) {
+  MYseed = seed;
+}
+
+void Knob::turn(unsigned long at, long states, unsigned long usPerState, unsigned long bounceUs) {
+  if (MYcount < MOVES) MYmoves[MYcount++] = {at, states, usPerState, bounceUs, false};
+}
+
+void Knob::press(unsigned long at, unsigned long heldUs, unsigned long bounceUs) {
+  if (MYcount < MOVES) MYmoves[MYcount++] = {at, (long) heldUs, 0, bounceUs, true};
+}
+
+//bouncing===========================================================================
+//Within "bounce" microseconds of an edge, a contact reads open or closed at random
+//The draw changes every 20us, like a real bounce
+//-----------------------------------------------------------------------------------
+bool Knob::bouncing(unsigned long us, unsigned long edge, unsigned long bounce, int salt) {
+  if (us < edge || us - edge >= bounce) return false;
+  unsigned long x = (us / 20) * 2654435761UL ^ (MYseed * 40503UL + salt);
+  x ^= x >> 13; x *= 0x5bd1e995UL; x ^= x >> 15;
+  return x & 1;
+}
+
+byte Knob::closed(unsigned long us) {
+  long position = 0;                              //States turned so far (+ CW)
+  byte flip = 0;                                  //Contacts that are bouncing
+  bool pressed = false;
+  for (int m = 0 ; m < MYcount ; m++) {
+    const Move &move = MYmoves[m];
+    if (us < move.at) continue;
+    if (move.press) {
+      unsigned long release = move.at + move.states;
+      pressed = pressed || us < release;
+      if (bouncing(us, move.at, move.bounce, m) || bouncing(us, release, move.bounce, m)) flip |= CLOSED_S;
+      continue;
+    }
+    long total = move.states < 0 ? -move.states : move.states;
+    if (total == 0) continue;
+    long done = min((long) ((us - move.at) / move.period) + 1, total);
+    byte before = cw[((position + (move.states < 0 ? -(done - 1) : done - 1)) % 4 + 4) % 4];
+    position += move.states < 0 ? -done : done;
+    byte after = cw[(position % 4 + 4) % 4];
+    unsigned long edge = move.at + (done - 1) * move.period;
+    if (bouncing(us, edge, move.bounce, m)) flip |= ((before ^ after) & 2 ? CLOSED_A : 0) | ((before ^ after) & 1 ? CLOSED_B : 0);
+  }
+  byte state = cw[(position % 4 + 4) % 4];
+  byte contacts = (state & 2 ? 0 : CLOSED_A) | (state & 1 ? 0 : CLOSED_B) | (pressed ? CLOSED_S : 0);
+  return contacts ^ flip;
+}
+
+long Knob::clicks(int type) {
+  long states = 0;
+  for (int m = 0 ; m < MYcount ; m++) if (!MYmoves[m].press) states += MYmoves[m].states;
+  return states / type;
+}
+
+unsigned long Knob::end() {
+  unsigned long last = 0;
+  for (int m = 0 ; m < MYcount ; m++) {
+    const Move &move = MYmoves[m];
+    unsigned long over = move.press ? move.at + move.states : move.at + (move.states < 0 ? -move.states : move.states) * move.period;
+    if (over + move.bounce > last) last = over + move.bounce;
+  }
+  return last;
+}
@@ -0,0 +1,36 @@
+/*
+  Knob.h
+  Released into the public domain.
+
+  A scripted encoder for the simulated board (see Board.h) :
+    turn()  : rotates it by a number of quadrature states (+ CW, - CCW), one state every "usPerState"
+    press() : holds it's switch down
+  Every contact that changes bounces for "bounceUs" : it reads open or closed at random
+  Knobs placed on the board answer for their contacts at any virtual time, so nothing has to be stepped
+*/
+
+#ifndef Knob_h
+#define Knob_h
+
+#include "Board.h"
+
+class Knob : public Contacts
+{
+  public:
+    Knob(unsigned long seed = 1);
+    void turn(unsigned long at, long states, unsigned long usPerState, unsigned long bounceUs = 0); //Rotate from "at"
+    void press(unsigned long at, unsigned long heldUs, unsigned long bounceUs = 0); //Hold the switch from "at"
+    byte closed(unsigned long us);                //CLOSED_A, CLOSED_B and CLOSED_S bits at time "us"
+    long clicks(int type);                        //Clicks scripted so far for an encoder of "type" steps per detent (+ CW, - CCW)
+    unsigned long end();                          //When the script is over (bounces included)
+
+  private:
+    struct Move { unsigned long at; long states; unsigned long period; unsigned long bounce; bool press; };
+    enum { MOVES = 64 };
+    bool bouncing(unsigned long us, unsigned long edge, unsigned long bounce, int salt); //Is a bouncing contact open
+    Move MYmoves[MOVES];
+    int MYcount = 0;
+    unsigned long MYseed;
+};
+
+#endif
@@ -0,0 +1,110 @@
+/*
+  Panel.h
+  Released into the public domain.
+
+  Helpers shared by the tests and the benchmark :
+    BoardStrobe : a strobe device that drives the common lines of the simulated board and counts it's transfers
+    Tally       : counts the actions returned by the library, with the indexes given by PANEL_INDEX
+    Recording   : contacts that hold the state they are given, for tests that replay samples one read at a time
+    recorded    : a bank of one encoder on Recording contacts
+*/
+
+#ifndef Panel_h
+#define Panel_h
+
+#include "Board.h"
+#include "CommonBusEncoders.h"
+
+#define PANEL_MAX 256                             //Encoders in a panel
+#define PANEL_INDEX(id) ((id) * 10)               //indexE of encoder "id" (CW : + 0, CCW : + 1), it's switch : + 5, release : + 6, long press : + 7
+
+//BoardStrobe=====================================================================
+//Drives line "n" of the board's strobe device (common STROBE_LINE + n)
+//A select() takes one transfer, that costs about a digitalWrite()
+//--------------------------------------------------------------------------------
+class BoardStrobe : public CommonBusStrobe
+{
+  public:
+    void select(int line) {
+      if (MYline >= 0) Board::drive(STROBE_LINE + MYline, HIGH);
+      if (line >= 0) Board::drive(STROBE_LINE + line, LOW);
+      MYline = line;
+      Board::now += Board::writeCost;
+      MYtransfers++;
+    }
+  private:
+    int MYline = -1;
+};
+
+//Recording=======================================================================
+//Contacts that hold the state they are given
+//--------------------------------------------------------------------------------
+struct Recording : Contacts {
+  byte ab = 3;                                    //A << 1 | B, HIGH when open (3 : on detent)
+  bool s = false;                                 //The switch is closed
+  byte closed(unsigned long) { return (ab & 2 ? 0 : CLOSED_A) | (ab & 1 ? 0 : CLOSED_B) | (s ? CLOSED_S : 0); }
+};
+
+//recorded========================================================================
+//A bank of one encoder on pin 10, it's contacts held by "contacts" (reset to open, on detent),
+//it's indexes PANEL_INDEX(1) (CW), + 1 (CCW) and + 5 (switch)
+//--------------------------------------------------------------------------------
+inline CommonBusEncoders *recorded(Recording &contacts) {
+  Board::busses(0, 0, 1, 2);
+  contacts = Recording();
+  Board::place(10, 0, &contacts);
+  CommonBusEncoders *e = new CommonBusEncoders(0, 1, 2, 1);
+  e->addEncoder(1, 4, 10, 1, PANEL_INDEX(1), PANEL_INDEX(1) + 5);
+  return e;
+}
+
+//Tally===========================================================================
+//The actions of each encoder of a panel, found from their index
+//--------------------------------------------------------------------------------
+struct Tally {
+  long cw[PANEL_MAX + 1];
+  long ccw[PANEL_MAX + 1];
+  long pressed[PANEL_MAX + 1];
+  long released[PANEL_MAX + 1];
+  long held[PANEL_MAX + 1];
+  Tally() { clear(); }
+  void clear() { memset(this, 0, sizeof(Tally)); }
+  void count(int index) {
+    int id = index / 10;
+    if (index <= 0 || id > PANEL_MAX) return;
+    switch (index % 10) {
+      case 0: cw[id]++; break;
+      case 1: ccw[id]++; break;
+      case 5: pressed[id]++; break;
+      case 6: released[id]++; break;
+      case 7: held[id]++; break;
+    }
+  }
+  void drain(CommonBusEncoders &e) {                //Take every action waiting in the queue
+    CommonBusEncoders::Event ev;
+    while (e.poll(ev)) count(ev.index);
+  }
+};
+
+//Drives readAll() like a sketch's loop() that takes "loopUs" for it's own work, until "until"
+inline void runLoop(CommonBusEncoders &e, Tally &t, unsigned long until, unsigned long loopUs) {
+  while (Board::now < until) {
+    t.count(e.readAll());
+    Board::advance(loopUs);
+  }
+  t.drain(e);
+}
+
+//Drives tick() like a timer interrupt "hz" times per second, and empties the queue every millisecond, until "until"
+inline void runTicks(CommonBusEncoders &e, Tally &t, unsigned long until, unsigned long hz) {
+  unsigned long period = 1000000UL / hz, next = Board::now;
+  while (Board::now < until) {
+    if (Board::now < next) Board::now = next;
+    e.tick();
+    next += period;
+    if (next / 1000 != (next - period) / 1000) t.drain(e);
+  }
+  t.drain(e);
+}
+
+#endif
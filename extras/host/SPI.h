@@ -0,0 +1,34 @@
+/*
+  SPI.h
+  Released into the public domain.
+
+  The SPI library of the Arduino core, on the simulated board (see Board.h) :
+  each transaction is logged (see BusLog.h) and each byte costs 1us of virtual time (8MHz)
+*/
+
+#ifndef SPI_h
+#define SPI_h
+
+#include "BusLog.h"
+#include "Board.h"
+
+#define SPI_MODE0 0x00
+
+class SPISettings
+{
+  public:
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) {}
+};
+
+class SPIClass : public BusLog
+{
+  public:
+    void begin() {}
+    void beginTransaction(SPISettings) { start(0); }
+    uint8_t transfer(uint8_t b) { add(b); Board::advance(1); return 0; }
+    void endTransaction() {}
+};
+
+extern SPIClass SPI;
+
+#endif
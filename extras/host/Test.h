@@ -0,0 +1,38 @@
+/*
+  Test.h
+  Released into the public domain.
+
+  A minimal test runner for the host build (see the Makefile) :
+    TEST(name) { ... CHECK(condition); CHECK_EQUAL(expected, actual); }
+  Every TEST of every test_*.cpp file is run by "make check"
+*/
+
+#ifndef Test_h
+#define Test_h
+
+#include <stdio.h>
+
+struct TestCase {
+  TestCase(const char *name, void (*run)());
+  const char *name;
+  void (*run)();
+  TestCase *next;
+};
+
+extern int testFailures;
+
+#define TEST(name) \
+  static void name(); \
+  static TestCase name##Case(#name, name); \
+  static void name()
+
+#define CHECK(condition) do { \
+    if (!(condition)) { printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); testFailures++; } \
+  } while (0)
+
+#define CHECK_EQUAL(expected, actual) do { \
+    long e_ = (long) (expected), a_ = (long) (actual); \
+    if (e_ != a_) { printf("  %s:%d: %s is %ld, expected %ld\n", __FILE__, __LINE__, #actual, a_, e_); testFailures++; } \
+  } while (0)
+
+#endif
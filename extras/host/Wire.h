@@ -0,0 +1,27 @@
+/*
+  Wire.h
+  Released into the public domain.
+
+  The Wire (I2C) library of the Arduino core, on the simulated board (see Board.h) :
+  each transmission is logged (see BusLog.h) and each byte costs 23us of virtual time (9 bits at 400kHz)
+*/
+
+#ifndef Wire_h
+#define Wire_h
+
+#include "BusLog.h"
+#include "Board.h"
+
+class TwoWire : public BusLog
+{
+  public:
+    void begin() {}
+    void setClock(uint32_t clock) {}
+    void beginTransmission(uint8_t address) { start(address); Board::advance(23); }
+    size_t write(uint8_t b) { add(b); Board::advance(23); return 1; }
+    uint8_t endTransmission() { return 0; }
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,103 @@
+/*
+  bench.cpp
+  Released into the public domain.
+
+  Host benchmark of banks of 1 to 256 encoders on the simulated board (see Board.h)
+  The common pins are the lines of a strobe device (BoardStrobe), so that 256 of them fit
+  For each bank, without any encoder turned :
+    mode    : readAll (default), fullScan (setFullScan) or tick (one tick() per call)
+    min/avg/max us : the virtual time taken by one call, with the costs of a Mega (Board::readCost...)
+    host ns : the time taken by one call on this computer (simulated board included, so only compare
+              it within one build)
+    scans/s : the number of times per second every encoder of the bank is read (virtual time)
+  The busses are read with digitalRead(), or from the port registers when built with -D__AVR__ (make bench)
+  Then, with knob 1 turned CW and knob N turned CCW (40 clicks each, 2ms of bounce on every edge) :
+    mode    : readAll (a loop() that spends 200us on it's own work), tick at 1kHz or 2kHz (Background)
+    missed   : clicks that were never reported
+    reversed : clicks reported in the wrong direction
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include "Panel.h"
+#include "Knob.h"
+
+#define CALLS 200                                 //Calls measured for each bank and mode
+#define PIN_A 0
+#define PIN_B 1
+#define PIN_S 2
+
+//build=============================================================================
+//A bank of "n" encoders of 4 steps per detent on the board's strobe lines
+//----------------------------------------------------------------------------------
+static CommonBusEncoders *build(int n, BoardStrobe &strobe) {
+  Board::reset();
+  Board::busses(0, PIN_A, PIN_B, PIN_S);
+  CommonBusEncoders *e = new CommonBusEncoders(PIN_A, PIN_B, PIN_S, n, &strobe);
+  for (int id = 1 ; id <= n ; id++) e->addEncoder(id, 4, id - 1, 1, PANEL_INDEX(id), PANEL_INDEX(id) + 5);
+  return e;
+}
+
+//measure===========================================================================
+//Times CALLS calls of readAll() (or tick()) and prints a line
+//"perScan" is the number of calls needed to read every encoder of the bank once
+//----------------------------------------------------------------------------------
+static void measure(int n, const char *mode, bool fullScan, bool ticks, int perScan) {
+  BoardStrobe strobe;
+  CommonBusEncoders *e = build(n, strobe);
+  e->setFullScan(fullScan);
+  unsigned long lo = 0xffffffff, hi = 0, total = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0 ; i < CALLS ; i++) {
+    unsigned long before = Board::now;
+    if (ticks) e->tick();
+    else       e->readAll();
+    unsigned long spent = Board::now - before;
+    if (spent < lo) lo = spent;
+    if (spent > hi) hi = spent;
+    total += spent;
+  }
+  double host = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / CALLS;
+  printf("%d\t%s\t%lu\t%lu\t%lu\t%.0f\t%.1f\t-\t-\n", n, mode, lo, total / CALLS, hi, host, 1e6 * CALLS / total / perScan);
+  delete e;
+}
+
+//knobs=============================================================================
+//Turns knob 1 CW and knob N CCW (at once) and prints the clicks missed and reversed
+//"hz" : tick() rate (0 : readAll() in a loop)
+//----------------------------------------------------------------------------------
+static void knobs(int n, const char *mode, unsigned long hz) {
+  BoardStrobe strobe;
+  CommonBusEncoders *e = build(n, strobe);
+  Knob first(1), last(2);
+  first.turn(100000, 160, 12000, 2000);           //40 clicks CW, 12ms per state
+  last.turn(150000, -160, 17000, 2000);           //40 clicks CCW, 17ms per state
+  Board::place(STROBE_LINE + 0, 0, &first);
+  if (n > 1) Board::place(STROBE_LINE + n - 1, 0, &last);
+  Tally t;
+  unsigned long until = (n > 1 ? last.end() : first.end()) + 100000;
+  if (hz == 0) runLoop(*e, t, until, 200);
+  else         runTicks(*e, t, until, hz);
+  long missed = 40 - t.cw[1], reversed = t.ccw[1];
+  if (n > 1) { missed += 40 - t.ccw[n]; reversed += t.cw[n]; }
+  printf("%d\t%s\t-\t-\t-\t-\t-\t%ld\t%ld\n", n, mode, missed > 0 ? missed : 0, reversed);
+  delete e;
+}
+
+int main() {
+#if defined(__AVR__)
+  printf("Busses read from the port registers (AVR)\n");
+#else
+  printf("Busses read with digitalRead()\n");
+#endif
+  printf("N\tmode\tmin us\tavg us\tmax us\thost ns\tscans/s\tmissed\treversed\n");
+  for (int n = 1 ; n <= PANEL_MAX ; n *= 2) {
+    measure(n, "readAll", false, false, 1);      //No encoder active : every encoder is read
+    measure(n, "fullScan", true, false, 1);
+    measure(n, "tick", false, true, n);
+    knobs(n, "readAll", 0);
+    knobs(n, "tick1k", 1000);
+    knobs(n, "tick2k", 2000);
+  }
+  return 0;
+}
@@ -0,0 +1,93 @@
+/*
+  compare.cpp
+  Released into the public domain.
+
+  Host benchmark of the library against an earlier revision of it (make compare REF=<revision>)
+  Both revisions are compiled into this program, each in it's own namespace (REF_SOURCE and NEW_SOURCE
+  are their CommonBusEncoders.cpp), and their runs alternate, so that both see the same load on this computer
+  Only what every revision since the full scan mode has is used : the constructor with the common pins
+  on Arduino pins, addEncoder(), readAll(), setFullScan() and tick(). Busses on pins 0, 1 and 2,
+  encoders of 4 steps per detent on pins 3 and up
+  For each bank of 1 to 128 encoders, without any encoder turned :
+    mode    : readAll (default), fullScan (setFullScan) or tick (one tick() per call)
+    us      : the virtual time taken by one call (see Board.h), the same unless the pins are accessed differently
+    ns      : the time taken by one call on this computer, the best of REPEATS runs (simulated board included)
+    new/ref : the ratio of the two
+*/
+
+#include <stdio.h>
+#include <chrono>
+#include "Board.h"
+
+namespace ref {
+#include REF_SOURCE
+}
+#undef CommonBusEncoder_h
+namespace now {
+#include NEW_SOURCE
+}
+
+#define CALLS   200                               //Calls timed in a run
+#define REPEATS 200                               //Runs of each revision, in turn : the best one is kept
+
+//build=============================================================================
+//A bank of "n" encoders on pins 3 and up
+//----------------------------------------------------------------------------------
+template <class Bank>
+static Bank *build(int n, bool fullScan) {
+  Bank *e = new Bank(0, 1, 2, n);
+  for (int id = 1 ; id <= n ; id++) e->addEncoder(id, 4, id + 2, 1, id * 10, id * 10 + 5);
+  e->setFullScan(fullScan);
+  return e;
+}
+
+//run===============================================================================
+//Times CALLS calls of readAll() (or tick()), keeps the best time on this computer (ns) and adds up the virtual time (us)
+//----------------------------------------------------------------------------------
+template <class Bank>
+static void run(Bank *e, bool ticks, double &best, unsigned long &virtualTotal) {
+  unsigned long before = Board::now;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0 ; i < CALLS ; i++) {
+    if (ticks) e->tick();
+    else       e->readAll();
+  }
+  double host = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / CALLS;
+  if (host < best) best = host;
+  virtualTotal += Board::now - before;
+}
+
+//measure===========================================================================
+//Times both revisions on a bank of "n" encoders and prints a line
+//----------------------------------------------------------------------------------
+static void measure(int n, const char *mode, bool fullScan, bool ticks) {
+  Board::reset();
+  Board::busses(0, 0, 1, 2);
+  ref::CommonBusEncoders *r = build<ref::CommonBusEncoders>(n, fullScan);
+  now::CommonBusEncoders *w = build<now::CommonBusEncoders>(n, fullScan);
+  double bestRef = 1e30, bestNew = 1e30;
+  unsigned long usRef = 0, usNew = 0;
+  for (int k = 0 ; k < REPEATS ; k++) {
+    run(r, ticks, bestRef, usRef);
+    run(w, ticks, bestNew, usNew);
+  }
+  printf("%d\t%s\t%lu\t%.0f\t%lu\t%.0f\t%.2f\n", n, mode, usRef / (CALLS * REPEATS), bestRef,
+         usNew / (CALLS * REPEATS), bestNew, bestNew / bestRef);
+  delete r;
+  delete w;
+}
+
+int main() {
+#if defined(__AVR__)
+  printf("Busses read from the port registers (AVR)\n");
+#else
+  printf("Busses read with digitalRead()\n");
+#endif
+  printf("N\tmode\tref us\tref ns\tnew us\tnew ns\tnew/ref\n");
+  for (int n = 1 ; n <= 128 ; n *= 2) {
+    measure(n, "readAll", false, false);
+    measure(n, "fullScan", true, false);
+    measure(n, "tick", false, true);
+  }
+  return 0;
+}
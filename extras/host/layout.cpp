@@ -0,0 +1,22 @@
+/*
+  layout.cpp
+  Released into the public domain.
+
+  A sketch that uses every constructor (see "make layout") : it links only when it is compiled
+  with the same CBE_QUEUE_SIZE, CBE_HOT_SIZE and CBE_STATS as the library
+*/
+
+#include "Board.h"
+#include "CommonBusEncoders.h"
+
+static const byte pinsA[2] = {0, 3};
+static const byte pinsB[2] = {1, 4};
+static const byte pinsS[2] = {2, 5};
+const CommonBusEncoders::Config table[1] PROGMEM = {{4, 10, 1, 10, 15, 16, 17}};
+
+int main() {
+  CommonBusEncoders single(0, 1, 2, 1);
+  CommonBusEncoders banks(pinsA, pinsB, pinsS, 2, 2);
+  StaticCommonBusEncoders<1> fixed(0, 1, 2, table);
+  return single.readAll() + banks.readAll() + fixed.readAll();
+}
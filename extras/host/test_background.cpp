@@ -0,0 +1,50 @@
+/*
+  test_background.cpp
+  Released into the public domain.
+
+  Reading in the background (background) : tick() at 1kHz, as from the timer of the Background example
+*/
+
+#include "Test.h"
+#include "Panel.h"
+#include "Knob.h"
+
+//twoKnobs========================================================================
+//A bank of "n" encoders on the board's strobe lines, knob 1 turned 40 clicks CW and knob "n" 40 clicks CCW,
+//at once, "us" and us + 5ms per state, both with 2ms of bounce on every edge, read by tick() at "hz"
+//--------------------------------------------------------------------------------
+static void twoKnobs(int n, unsigned long us, unsigned long hz, Tally &t) {
+  BoardStrobe strobe;
+  Board::busses(0, 0, 1, 2);
+  CommonBusEncoders e(0, 1, 2, n, &strobe);
+  for (int id = 1 ; id <= n ; id++) e.addEncoder(id, 4, id - 1, 1, PANEL_INDEX(id), PANEL_INDEX(id) + 5);
+  e.setBackground(true);
+  Knob first(1), last(2);
+  first.turn(100000, 160, us, 2000);
+  last.turn(150000, -160, us + 5000, 2000);
+  Board::place(STROBE_LINE + 0, 0, &first);
+  Board::place(STROBE_LINE + n - 1, 0, &last);
+  runTicks(e, t, last.end() + 100000, hz);
+}
+
+//Both knobs are noticed before they leave their first state (2 x 19 ticks), then join the set of active
+//encoders : none of their clicks is lost
+TEST(twoKnobsAt1kHz) {
+  Tally t;
+  twoKnobs(19, 45000, 1000, t);
+  CHECK_EQUAL(40, t.cw[1]);
+  CHECK_EQUAL(0, t.ccw[1]);
+  CHECK_EQUAL(40, t.ccw[19]);
+  CHECK_EQUAL(0, t.cw[19]);
+}
+
+//Knobs that leave their first state before they are noticed lose that click, but only that one :
+//they are read at the pace of the active encoders from their first move on
+TEST(twoFastKnobsAt1kHz) {
+  Tally t;
+  twoKnobs(19, 12000, 1000, t);
+  CHECK_EQUAL(39, t.cw[1]);
+  CHECK_EQUAL(0, t.ccw[1]);
+  CHECK_EQUAL(39, t.ccw[19]);
+  CHECK_EQUAL(0, t.cw[19]);
+}
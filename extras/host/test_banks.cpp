@@ -0,0 +1,118 @@
+/*
+  test_banks.cpp
+  Released into the public domain.
+
+  Several banks (banks) : the encoders of every bank on a common pin, read at once
+*/
+
+#include "Test.h"
+#include "Panel.h"
+#include "Knob.h"
+
+static const byte pinsA[2] = {0, 3};
+static const byte pinsB[2] = {1, 4};
+static const byte pinsS[2] = {2, 5};
+
+//banks===========================================================================
+//"n" encoders of 4 steps per detent in two banks, common pins 20 and up (encoderId 1 and 2 on pin 20...),
+//with "modes" modes each and no debouncing
+//--------------------------------------------------------------------------------
+static CommonBusEncoders *banks(int n, int modes) {
+  Board::busses(0, 0, 1, 2);
+  Board::busses(1, 3, 4, 5);
+  CommonBusEncoders *e = new CommonBusEncoders(pinsA, pinsB, pinsS, 2, n);
+  for (int id = 1 ; id <= n ; id++) e->addEncoder(id, 4, 20 + (id - 1) / 2, modes, PANEL_INDEX(id), 0);
+  e->setDebounce(1);
+  return e;
+}
+
+//Two knobs on the same common pin, in two banks, turned at once
+TEST(banksShareTheCommonPin) {
+  CommonBusEncoders *e = banks(4, 1);
+  Knob first(1), second(2);
+  first.turn(10000, 40, 8000, 1000);
+  second.turn(12000, -40, 7000, 1000);
+  Board::place(20, 0, &first);
+  Board::place(20, 1, &second);
+  e->setDebounce(4);
+  Tally t;
+  runLoop(*e, t, first.end() + 10000, 200);
+  CHECK_EQUAL(10, t.cw[1]);
+  CHECK_EQUAL(0, t.ccw[1]);
+  CHECK_EQUAL(10, t.ccw[2]);
+  CHECK_EQUAL(0, t.cw[2]);
+  delete e;
+}
+
+//Banks wired to ports (see the Constructor with several banks) : on an AVR board, bank n on the same bit of the
+//A, B and S ports is sampled with one read per port, shifted by the bit of bank 1 (MYlaneShift)
+struct Wiring { byte a[3], b[3], s[3]; int banks; bool aligned; };
+static const Wiring wirings[3] = {
+  {{ 8,  9,  0}, {16, 17,  0}, {24, 25,  0}, 2, true},   //Bits 0 and 1 of ports 2, 3 and 4
+  {{10, 11, 12}, {18, 19, 20}, {26, 27, 28}, 3, true},   //Bits 2 to 4 : shifted
+  {{ 0,  3,  6}, { 1,  4,  7}, { 2,  5,  8}, 3, false}   //Not aligned : read pin by pin
+};
+
+//Knobs turned at once in every bank, on common pin 40 : every click, and no digitalRead() when the banks are aligned
+TEST(banksOnePerPortBit) {
+  for (const Wiring &w : wirings) {
+    Board::reset();
+    for (int l = 0 ; l < w.banks ; l++) Board::busses(l, w.a[l], w.b[l], w.s[l]);
+    CommonBusEncoders e(w.a, w.b, w.s, w.banks, 2 * w.banks);
+    for (int id = 1 ; id <= 2 * w.banks ; id++) e.addEncoder(id, 4, 40 + (id - 1) / w.banks, 1, PANEL_INDEX(id), 0);
+    e.setFullScan(true);
+    Knob knobs[3] = {Knob(1), Knob(2), Knob(3)};
+    for (int l = 0 ; l < w.banks ; l++) {
+      knobs[l].turn(10000 + l * 3000, (l % 2) ? -40 : 40, 7000 + l * 1000, 1000);
+      Board::place(40, l, &knobs[l]);
+    }
+    Board::reads = 0;
+    Tally t;
+    runLoop(e, t, knobs[w.banks - 1].end() + 10000, 200);
+    for (int l = 0 ; l < w.banks ; l++) {
+      CHECK_EQUAL(10, (l % 2) ? t.ccw[l + 1] : t.cw[l + 1]);
+      CHECK_EQUAL(0, (l % 2) ? t.cw[l + 1] : t.ccw[l + 1]);
+    }
+#if defined(__AVR__)
+    if (w.aligned) CHECK_EQUAL(0, Board::reads);
+    else           CHECK(Board::reads > 0);
+#endif
+  }
+}
+
+//click===========================================================================
+//Turns "c" one click CW, one readAll() per state, and returns the last index reported
+//--------------------------------------------------------------------------------
+static int click(CommonBusEncoders &e, Recording &c) {
+  const byte cw[4] = {1, 0, 2, 3};
+  int index = 0;
+  for (byte ab : cw) {
+    c.ab = ab;
+    int i = e.readAll();
+    if (i != 0) index = i;
+  }
+  Board::advance(10000);
+  return index;
+}
+
+//When a common pin leaves the set of active encoders, only the encoders that were active reset their mode
+TEST(timeoutResetsTheActiveEncodersOnly) {
+  CommonBusEncoders *e = banks(10, 2);
+  Recording contacts[10];
+  for (int id = 1 ; id <= 10 ; id++) Board::place(20 + (id - 1) / 2, (id - 1) % 2, &contacts[id - 1]);
+  e->setFullScan(true);
+  contacts[1].s = true;                           //Encoder 2 (bank 2 of pin 20) to mode 1
+  e->readAll();
+  contacts[1].s = false;
+  e->readAll();
+  Board::advance(10000);
+  for (int id = 3 ; id <= 9 ; id += 2) click(*e, contacts[id - 1]); //Pins 21 to 24 : pin 20 leaves the full set
+  CHECK_EQUAL(PANEL_INDEX(1), click(*e, contacts[0]));              //Encoder 1 : pin 20 joins again
+  Board::advance(600000);
+  e->readAll();                                   //Every pin times out : encoder 1 was active, encoder 2 was not
+  CHECK_EQUAL(PANEL_INDEX(2) + 2, click(*e, contacts[1]));          //Still in mode 1
+  Board::advance(600000);
+  e->readAll();                                   //Now encoder 2 was active
+  CHECK_EQUAL(PANEL_INDEX(2), click(*e, contacts[1]));
+  delete e;
+}
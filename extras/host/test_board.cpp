@@ -0,0 +1,89 @@
+/*
+  test_board.cpp
+  Released into the public domain.
+
+  The simulated board itself : the diode matrix and the scripted knobs
+*/
+
+#include "Test.h"
+#include "Knob.h"
+
+//A closed contact only pulls it's bus down while the common pin is driven LOW
+TEST(matrixHonoursTheCommonPin) {
+  Knob k;
+  k.press(0, 1000000);
+  Board::busses(0, 0, 1, 2);
+  Board::place(10, 0, &k);
+  CHECK_EQUAL(HIGH, digitalRead(2));              //Pin 10 is not an output yet
+  pinMode(10, OUTPUT);
+  digitalWrite(10, HIGH);
+  CHECK_EQUAL(HIGH, digitalRead(2));
+  digitalWrite(10, LOW);
+  CHECK_EQUAL(LOW, digitalRead(2));
+  CHECK_EQUAL(HIGH, digitalRead(0));              //On detent : A and B are open
+  CHECK_EQUAL(HIGH, digitalRead(1));
+}
+
+//Each bank only sees the encoders placed on it
+TEST(matrixKeepsTheBanksApart) {
+  Knob k;
+  k.press(0, 1000000);
+  Board::busses(0, 0, 1, 2);
+  Board::busses(1, 3, 4, 5);
+  Board::place(STROBE_LINE + 7, 1, &k);
+  Board::drive(STROBE_LINE + 7, LOW);
+  CHECK_EQUAL(HIGH, digitalRead(2));
+  CHECK_EQUAL(LOW, digitalRead(5));
+}
+
+//A CW turn goes through the quadrature states 3, 1, 0, 2, 3 (A << 1 | B, HIGH when open)
+TEST(knobTurnsThroughTheQuadrature) {
+  Knob k;
+  k.turn(1000, 4, 100);
+  const byte open[5] = {3, 1, 0, 2, 3};
+  for (int n = 0 ; n < 5 ; n++) {
+    byte c = k.closed(n == 0 ? 0 : 1000 + (n - 1) * 100);
+    CHECK_EQUAL(open[n], ((c & CLOSED_A) ? 0 : 2) | ((c & CLOSED_B) ? 0 : 1));
+  }
+  CHECK_EQUAL(1, k.clicks(4));
+  CHECK_EQUAL(2, k.clicks(2));
+}
+
+//A bouncing contact reads both ways during the bounce, and settles after it
+TEST(knobBounces) {
+  Knob k;
+  k.press(1000, 5000, 500);
+  int closed = 0;
+  for (unsigned long us = 1000 ; us < 1500 ; us += 20) closed += (k.closed(us) & CLOSED_S) != 0;
+  CHECK(closed > 0 && closed < 25);
+  CHECK(k.closed(1600) & CLOSED_S);
+  CHECK(!(k.closed(6600) & CLOSED_S));
+}
+
+//The virtual clock moves with the delays and the pin accesses
+TEST(clockAdvances) {
+  delayMicroseconds(7);
+  delay(2);
+  CHECK_EQUAL(2007, micros());
+  digitalRead(0);
+  CHECK_EQUAL(2007 + Board::readCost, micros());
+  CHECK_EQUAL(2, millis());
+}
+
+#if defined(__AVR__)
+//The port registers drive the common pins, and the busses are sampled into them when they settle
+TEST(portsFollowTheMatrix) {
+  Knob k;
+  k.press(0, 1000000);
+  Board::busses(0, 0, 1, 2);
+  Board::place(10, 0, &k);
+  pinMode(10, OUTPUT);
+  *portOutputRegister(digitalPinToPort(10)) &= ~digitalPinToBitMask(10);
+  delayMicroseconds(1);
+  CHECK_EQUAL(0, *portInputRegister(digitalPinToPort(2)) & digitalPinToBitMask(2));
+  CHECK(*portInputRegister(digitalPinToPort(0)) & digitalPinToBitMask(0));
+  *portOutputRegister(digitalPinToPort(10)) |= digitalPinToBitMask(10);
+  delayMicroseconds(1);
+  CHECK(*portInputRegister(digitalPinToPort(2)) & digitalPinToBitMask(2));
+}
+#endif
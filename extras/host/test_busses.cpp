@@ -0,0 +1,54 @@
+/*
+  test_busses.cpp
+  Released into the public domain.
+
+  Reading the busses (readBusses) : the same actions come out of digitalRead() and of the port registers
+  (make check runs every test both ways)
+*/
+
+#include "Test.h"
+#include "Panel.h"
+#include "Knob.h"
+
+//Three encoders on Arduino pins : each reports it's own clicks, and the one that is not turned stays silent
+TEST(busesReadTheEnabledEncoderOnly) {
+  Board::busses(0, 20, 21, 22);
+  CommonBusEncoders e(20, 21, 22, 3);
+  e.setFullScan(true);
+  Knob one(1), three(3);
+  one.turn(10000, 8, 3000);                       //2 clicks CW
+  three.turn(10000, -12, 3000);                   //3 clicks CCW
+  for (int id = 1 ; id <= 3 ; id++) e.addEncoder(id, 4, 29 + id, 1, PANEL_INDEX(id), PANEL_INDEX(id) + 5);
+  Board::place(30, 0, &one);
+  Board::place(32, 0, &three);
+  Tally t;
+  runLoop(e, t, 100000, 100);
+  CHECK_EQUAL(2, t.cw[1]);
+  CHECK_EQUAL(0, t.ccw[1]);
+  CHECK_EQUAL(0, t.cw[2] + t.ccw[2]);
+  CHECK_EQUAL(3, t.ccw[3]);
+  CHECK_EQUAL(0, t.cw[3]);
+#if defined(__AVR__)
+  CHECK_EQUAL(0, Board::reads);                   //Not a single digitalRead()
+  CHECK_EQUAL(3, Board::writes);                  //Only attaching the common pins
+#endif
+}
+
+//With the three busses on the same port, and on three different ports
+TEST(busesOnOneOrThreePorts) {
+  const int pins[2][3] = {{0, 1, 2}, {8, 17, 26}};
+  for (int w = 0 ; w < 2 ; w++) {
+    Board::reset();
+    Board::busses(0, pins[w][0], pins[w][1], pins[w][2]);
+    CommonBusEncoders e(pins[w][0], pins[w][1], pins[w][2], 1);
+    e.addEncoder(1, 4, 40, 1, PANEL_INDEX(1), PANEL_INDEX(1) + 5);
+    Knob k;
+    k.turn(5000, 4, 2000);
+    k.press(20000, 5000);
+    Board::place(40, 0, &k);
+    Tally t;
+    runLoop(e, t, 40000, 100);
+    CHECK_EQUAL(1, t.cw[1]);
+    CHECK_EQUAL(1, t.pressed[1]);
+  }
+}
@@ -0,0 +1,119 @@
+/*
+  test_debounce.cpp
+  Released into the public domain.
+
+  Debouncing the busses (debounce) : bouncing samples of A, B and S, one per read, and the width of setDebounce()
+*/
+
+#include "Test.h"
+#include "Panel.h"
+#include "Knob.h"
+
+static Recording contacts;
+
+//single==========================================================================
+//The encoder of recorded(), debounced over "width" reads (width < 0 : default)
+//--------------------------------------------------------------------------------
+static CommonBusEncoders *single(int width) {
+  CommonBusEncoders *e = recorded(contacts);
+  if (width >= 0) e->setDebounce(width);
+  return e;
+}
+
+//readsToPress====================================================================
+//Closes the switch and returns the number of reads until the press is reported (0 : never, within 100)
+//--------------------------------------------------------------------------------
+static int readsToPress(CommonBusEncoders &e) {
+  contacts.s = true;
+  for (int n = 1 ; n <= 100 ; n++) if (e.readAll() == PANEL_INDEX(1) + 5) return n;
+  return 0;
+}
+
+//The press is confirmed after exactly "width" reads
+TEST(widthIsTheNumberOfReads) {
+  const int widths[] = {1, 2, 4, 8, 16, 32};
+  for (int w : widths) {
+    CommonBusEncoders *e = single(w);
+    CHECK_EQUAL(w, readsToPress(*e));
+    delete e;
+  }
+}
+
+//The default width is 4 reads, and the width is kept within 1..32
+TEST(widthDefaultAndLimits) {
+  CommonBusEncoders *e = single(-1);
+  CHECK_EQUAL(4, readsToPress(*e));
+  delete e;
+  Board::reset();
+  e = single(0);
+  CHECK_EQUAL(1, readsToPress(*e));
+  delete e;
+  Board::reset();
+  e = single(100);
+  CHECK_EQUAL(32, readsToPress(*e));
+  delete e;
+}
+
+//A width changed while a contact is on it's way takes effect on the next read
+TEST(widthLoweredOnTheWay) {
+  CommonBusEncoders *e = single(32);
+  contacts.s = true;
+  for (int n = 0 ; n < 10 ; n++) CHECK_EQUAL(0, e->readAll());
+  e->setDebounce(4);
+  CHECK_EQUAL(4, readsToPress(*e));
+  delete e;
+}
+
+//A switch that bounces (closed and open in turn) is not pressed until it stays closed for "width" reads
+TEST(bouncingSwitch) {
+  CommonBusEncoders *e = single(4);
+  const bool samples[] = {1, 0, 1, 0, 1, 1, 0, 1, 0, 1, 0, 0, 1, 0};
+  for (bool closed : samples) {
+    contacts.s = closed;
+    CHECK_EQUAL(0, e->readAll());
+  }
+  CHECK_EQUAL(4, readsToPress(*e));
+  const bool release[] = {0, 1, 0, 1, 0, 1};      //The release bounces too : it is still pressed
+  for (bool closed : release) {
+    contacts.s = closed;
+    CHECK_EQUAL(0, e->readAll());
+  }
+  delete e;
+}
+
+//Bounces on A or B between two states do not step the encoder back and forth
+TEST(bouncingQuadrature) {
+  CommonBusEncoders *e = single(4);
+  const byte samples[] = {3, 1, 3, 1, 3, 1, 1, 1, 1,   //A closes, bouncing
+                          0, 1, 0, 1, 0, 0, 0, 0,      //B closes, bouncing
+                          2, 0, 2, 0, 2, 2, 2, 2,      //A opens, bouncing
+                          3, 2, 3, 2, 3, 3, 3, 3};     //B opens, bouncing : detent
+  Tally t;
+  for (byte ab : samples) {
+    contacts.ab = ab;
+    t.count(e->readAll());
+  }
+  CHECK_EQUAL(1, t.cw[1]);
+  CHECK_EQUAL(0, t.ccw[1]);
+  delete e;
+}
+
+//Knobs turned with 1ms of bounce on every edge, read every 200us : every click, in the right direction
+TEST(bouncingKnobs) {
+  Board::busses(0, 0, 1, 2);
+  CommonBusEncoders e(0, 1, 2, 2);
+  e.setFullScan(true);
+  Knob cw(1), ccw(2);
+  cw.turn(10000, 40, 8000, 1000);
+  ccw.turn(15000, -40, 9000, 1000);
+  e.addEncoder(1, 4, 10, 1, PANEL_INDEX(1), PANEL_INDEX(1) + 5);
+  e.addEncoder(2, 4, 11, 1, PANEL_INDEX(2), PANEL_INDEX(2) + 5);
+  Board::place(10, 0, &cw);
+  Board::place(11, 0, &ccw);
+  Tally t;
+  runLoop(e, t, ccw.end() + 10000, 150);
+  CHECK_EQUAL(10, t.cw[1]);
+  CHECK_EQUAL(0, t.ccw[1]);
+  CHECK_EQUAL(10, t.ccw[2]);
+  CHECK_EQUAL(0, t.cw[2]);
+}
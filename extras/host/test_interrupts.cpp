@@ -0,0 +1,43 @@
+/*
+  test_interrupts.cpp
+  Released into the public domain.
+
+  Holding interrupts (interrupts) : what reads the state shared with tick() leaves interrupts as it found them
+*/
+
+#include "Test.h"
+#include "Panel.h"
+
+#if defined(__AVR__)
+
+//overflows() called from loop() enables interrupts again, called from an interrupt it does not
+TEST(overflowsRestoresInterrupts) {
+  Board::busses(0, 0, 1, 2);
+  CommonBusEncoders e(0, 1, 2, 1);
+  CHECK_EQUAL(0, e.overflows());
+  CHECK_EQUAL(0x80, SREG);
+  SREG = 0;                                       //As in an interrupt
+  CHECK_EQUAL(0, e.overflows());
+  CHECK_EQUAL(0, SREG);
+}
+
+#if CBE_STATS
+//So do stats(), clicks() and resetStats()
+TEST(statsRestoreInterrupts) {
+  Board::busses(0, 0, 1, 2);
+  CommonBusEncoders e(0, 1, 2, 1);
+  CommonBusEncoders::Stats s;
+  const uint8_t states[2] = {0x80, 0x00};         //From loop(), then as in an interrupt
+  for (uint8_t sreg : states) {
+    SREG = sreg;
+    e.stats(s);
+    CHECK_EQUAL(sreg, SREG);
+    CHECK_EQUAL(0, e.clicks(1));
+    CHECK_EQUAL(sreg, SREG);
+    e.resetStats();
+    CHECK_EQUAL(sreg, SREG);
+  }
+}
+#endif
+
+#endif
@@ -0,0 +1,97 @@
+/*
+  test_quadrature.cpp
+  Released into the public domain.
+
+  Decoding the rotation (readQuadrature), from recorded states of A and B (A << 1 | B, HIGH when open)
+  The encoder is debounced over a single read, so every read sees the next recorded state
+*/
+
+#include "Test.h"
+#include "Panel.h"
+
+//replay==========================================================================
+//Reads an encoder of "type" steps per detent once per recorded state
+//Returns the clicks reported : + CW, - CCW. "reversed" counts the clicks reported in both directions
+//--------------------------------------------------------------------------------
+static int replay(int type, const byte *states, int count, int *both = NULL) {
+  Board::reset();
+  Board::busses(0, 0, 1, 2);
+  Recording r;
+  Board::place(10, 0, &r);
+  CommonBusEncoders e(0, 1, 2, 1);
+  e.setDebounce(1);
+  e.addEncoder(1, type, 10, 1, PANEL_INDEX(1), 0);
+  Tally t;
+  for (int n = 0 ; n < count ; n++) {
+    r.ab = states[n];
+    t.count(e.readAll());
+    Board::advance(1000);
+  }
+  t.drain(e);
+  if (both != NULL) *both = t.cw[1] + t.ccw[1];
+  return t.cw[1] - t.ccw[1];
+}
+
+#define REPLAY(type, ...) ([]() { const byte s[] = {__VA_ARGS__}; return replay(type, s, sizeof(s)); })()
+
+TEST(fourStepsCW) {
+  CHECK_EQUAL(1, REPLAY(4, 3, 1, 0, 2, 3));
+  CHECK_EQUAL(2, REPLAY(4, 3, 1, 0, 2, 3, 1, 0, 2, 3));
+}
+
+TEST(fourStepsCCW) {
+  CHECK_EQUAL(-1, REPLAY(4, 3, 2, 0, 1, 3));
+  CHECK_EQUAL(-2, REPLAY(4, 3, 2, 0, 1, 3, 2, 0, 1, 3));
+}
+
+//Half a turn is not a click for an encoder of 4 steps per detent
+TEST(fourStepsNeedAFullCycle) {
+  CHECK_EQUAL(0, REPLAY(4, 3, 1, 0));
+}
+
+//An encoder of 2 steps per detent clicks on both detents (both HIGH and both LOW)
+TEST(twoStepsCW) {
+  CHECK_EQUAL(1, REPLAY(2, 3, 1, 0));
+  CHECK_EQUAL(2, REPLAY(2, 3, 1, 0, 2, 3));
+}
+
+TEST(twoStepsCCW) {
+  CHECK_EQUAL(-1, REPLAY(2, 3, 2, 0));
+  CHECK_EQUAL(-2, REPLAY(2, 3, 2, 0, 1, 3));
+}
+
+//A missed state (A and B changed together) drops the click instead of guessing it's direction
+TEST(missedStateGivesNoClick) {
+  int both = 0;
+  const byte skipped[] = {3, 1, 2, 3};            //0 was missed : 1 -> 2 is illegal
+  CHECK_EQUAL(0, replay(4, skipped, 4, &both));
+  CHECK_EQUAL(0, both);
+  const byte jumped[] = {3, 0, 3};                //Straight across
+  CHECK_EQUAL(0, replay(4, jumped, 3, &both));
+  CHECK_EQUAL(0, both);
+  const byte twoSteps[] = {3, 0};                 //2 steps per detent : both detents, nothing in between
+  CHECK_EQUAL(0, replay(2, twoSteps, 2, &both));
+  CHECK_EQUAL(0, both);
+}
+
+//After a missed state, the next clean click is counted
+TEST(clickAfterAMissedState) {
+  CHECK_EQUAL(1, REPLAY(4, 3, 1, 2, 3, 1, 0, 2, 3));
+}
+
+//Turned back before the detent : no click in either direction
+TEST(reversalBeforeTheDetent) {
+  int both = 0;
+  const byte back[] = {3, 1, 0, 1, 3};
+  CHECK_EQUAL(0, replay(4, back, 5, &both));
+  CHECK_EQUAL(0, both);
+  const byte twoSteps[] = {3, 1, 3};
+  CHECK_EQUAL(0, replay(2, twoSteps, 3, &both));
+  CHECK_EQUAL(0, both);
+}
+
+//A step back and forth on the way (contact jitter) still ends in one click
+TEST(jitterOnTheWay) {
+  CHECK_EQUAL(1, REPLAY(4, 3, 1, 0, 2, 0, 2, 3));
+  CHECK_EQUAL(-1, REPLAY(4, 3, 2, 2, 0, 1, 0, 1, 3));
+}
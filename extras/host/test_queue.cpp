@@ -0,0 +1,128 @@
+/*
+  test_queue.cpp
+  Released into the public domain.
+
+  The queue of events (queue) : CBE_QUEUE_SIZE events held, the others dropped and counted,
+  taken with poll() and readEvents(), the head and the tail wrapping around
+*/
+
+#include "Test.h"
+#include "Panel.h"
+
+static Recording contacts[20];
+
+//switches========================================================================
+//"n" encoders on pins 10 and up, read without debouncing, each switch reporting it's press and release
+//--------------------------------------------------------------------------------
+static CommonBusEncoders *switches(int n) {
+  Board::busses(0, 0, 1, 2);
+  CommonBusEncoders *e = new CommonBusEncoders(0, 1, 2, n);
+  for (int id = 1 ; id <= n ; id++) {
+    contacts[id - 1] = Recording();
+    Board::place(10 + id - 1, 0, &contacts[id - 1]);
+    e->addEncoder(id, 4, 10 + id - 1, 1, PANEL_INDEX(id), PANEL_INDEX(id) + 5);
+    e->setSwitchIndexes(id, PANEL_INDEX(id) + 6, PANEL_INDEX(id) + 7);
+  }
+  e->setDebounce(1);
+  return e;
+}
+
+//press===========================================================================
+//Closes (or opens) the switches of the first "n" encoders and queues their events with scan()
+//--------------------------------------------------------------------------------
+static void press(CommonBusEncoders &e, int n, bool closed) {
+  for (int id = 1 ; id <= n ; id++) contacts[id - 1].s = closed;
+  e.scan();
+}
+
+//A full queue holds CBE_QUEUE_SIZE events, drops the others and counts them
+TEST(queueHoldsItsSize) {
+  CommonBusEncoders *e = switches(20);
+  CHECK_EQUAL(0, e->pending());
+  press(*e, 20, true);
+  CHECK_EQUAL(CBE_QUEUE_SIZE, e->pending());
+  CHECK_EQUAL(20 - CBE_QUEUE_SIZE, e->overflows());
+  CommonBusEncoders::Event ev;
+  for (int id = 1 ; id <= CBE_QUEUE_SIZE ; id++) {  //The oldest first : the dropped ones are the last ones
+    CHECK(e->poll(ev));
+    CHECK_EQUAL(id, ev.encoderId);
+    CHECK_EQUAL(9, ev.action);
+    CHECK_EQUAL(PANEL_INDEX(id) + 5, ev.index);
+  }
+  CHECK(!e->poll(ev));
+  CHECK_EQUAL(0, e->pending());
+  press(*e, 20, false);                           //Room again : the releases are queued
+  CHECK_EQUAL(CBE_QUEUE_SIZE, e->pending());
+  CHECK_EQUAL(2 * (20 - CBE_QUEUE_SIZE), e->overflows());
+  delete e;
+}
+
+//readEvents() takes what is asked for, or what there is
+TEST(readEventsDrainsInParts) {
+  CommonBusEncoders *e = switches(12);
+  press(*e, 12, true);
+  CommonBusEncoders::Event buf[20];
+  CHECK_EQUAL(5, e->readEvents(buf, 5));
+  CHECK_EQUAL(1, buf[0].encoderId);
+  CHECK_EQUAL(5, buf[4].encoderId);
+  CHECK_EQUAL(7, e->pending());
+  CHECK_EQUAL(0, e->readEvents(buf, 0));
+  CHECK_EQUAL(7, e->readEvents(buf, 20));
+  CHECK_EQUAL(6, buf[0].encoderId);
+  CHECK_EQUAL(12, buf[6].encoderId);
+  CHECK_EQUAL(0, e->readEvents(buf, 20));
+  CHECK_EQUAL(0, e->pending());
+  CHECK_EQUAL(0, e->overflows());
+  delete e;
+}
+
+//The head and the tail wrap around (past the queue's size and past 255) : every event comes out once, in order
+TEST(queueWrapsAround) {
+  CommonBusEncoders *e = switches(3);
+  CommonBusEncoders::Event buf[CBE_QUEUE_SIZE];
+  int taken = 0;
+  for (int round = 0 ; round < 200 ; round++) {   //600 events, 3 at a time
+    bool closed = (round % 2 == 0);
+    press(*e, 3, closed);
+    CHECK_EQUAL(3, e->pending());
+    int n = (round % 3 == 0) ? e->readEvents(buf, 3) : 0;
+    while (n < 3 && e->poll(buf[n])) n++;
+    CHECK_EQUAL(3, n);
+    for (int k = 0 ; k < 3 ; k++) {
+      CHECK_EQUAL(k + 1, buf[k].encoderId);
+      CHECK_EQUAL(closed ? 9 : 10, buf[k].action);
+    }
+    taken += n;
+  }
+  CHECK_EQUAL(600, taken);
+  CHECK_EQUAL(0, e->overflows());
+  delete e;
+}
+
+//A queue filled across the wrap of the head (255 to 0) is still full at CBE_QUEUE_SIZE, and drains in order
+TEST(fullQueueAcrossTheWrap) {
+  CommonBusEncoders *e = switches(20);
+  CommonBusEncoders::Event ev;
+  for (int n = 0 ; n < 250 ; n++) {               //The head and the tail at 250, encoder 1 pressed then released
+    press(*e, 1, n % 2 == 0);
+    CHECK(e->poll(ev));
+  }
+  press(*e, 20, true);
+  CHECK_EQUAL(CBE_QUEUE_SIZE, e->pending());
+  CHECK_EQUAL(20 - CBE_QUEUE_SIZE, e->overflows());
+  for (int id = 1 ; id <= CBE_QUEUE_SIZE ; id++) {
+    CHECK(e->poll(ev));
+    CHECK_EQUAL(id, ev.encoderId);
+  }
+  CHECK(!e->poll(ev));
+  delete e;
+}
+
+//readAll() returns the oldest event, one per call
+TEST(readAllTakesTheOldest) {
+  CommonBusEncoders *e = switches(3);
+  press(*e, 3, true);
+  for (int id = 1 ; id <= 3 ; id++) CHECK_EQUAL(PANEL_INDEX(id) + 5, e->readAll());
+  CHECK_EQUAL(0, e->readAll());
+  delete e;
+}
@@ -0,0 +1,37 @@
+/*
+  test_static.cpp
+  Released into the public domain.
+
+  A bank that allocates no memory (static) : StaticCommonBusEncoders<N>, it's table in PROGMEM
+*/
+
+#include "Test.h"
+#include "Panel.h"
+#include "Knob.h"
+
+const CommonBusEncoders::Config table[3] PROGMEM = {
+  //type, pin, modes, indexE, indexS, indexR, indexL
+  {    4,  10,     1,     10,     15,     16,     17},
+  {    4,  11,     1,     20,     25,     26,     27},
+  {    2,  12,     1,     30,     35,     36,     37}
+};
+
+//The state lives in the object, laid out by CommonBusEncoders once it's storage (the first base) is constructed
+TEST(staticBankReadsItsTable) {
+  Board::busses(0, 0, 1, 2);
+  Knob second(1), third(2);
+  second.turn(10000, 40, 8000);                   //10 clicks CW, 4 steps per detent
+  third.turn(10000, -20, 9000);                   //10 clicks CCW, 2 steps per detent
+  Board::place(11, 0, &second);
+  Board::place(12, 0, &third);
+  StaticCommonBusEncoders<3> *e = new StaticCommonBusEncoders<3>(0, 1, 2, table);
+  e->setFullScan(true);
+  Tally t;
+  runLoop(*e, t, second.end() + 10000, 200);
+  CHECK_EQUAL(0, t.cw[1] + t.ccw[1]);
+  CHECK_EQUAL(10, t.cw[2]);
+  CHECK_EQUAL(0, t.ccw[2]);
+  CHECK_EQUAL(10, t.ccw[3]);
+  CHECK_EQUAL(0, t.cw[3]);
+  delete e;
+}
@@ -0,0 +1,44 @@
+/*
+  test_stats.cpp
+  Released into the public domain.
+
+  Statistics on the reads (stats) : only built with CBE_STATS set to 1 (tests_stats, see the Makefile)
+*/
+
+#include "Test.h"
+#include "Panel.h"
+#include "Knob.h"
+
+#if CBE_STATS
+
+//A knob turned with bouncing contacts : it's clicks, the reads and the bounces are counted, then start over
+TEST(statsCountTheClicks) {
+  Board::busses(0, 0, 1, 2);
+  CommonBusEncoders e(0, 1, 2, 2);
+  e.addEncoder(1, 4, 10, 1, PANEL_INDEX(1), PANEL_INDEX(1) + 5);
+  e.addEncoder(2, 4, 11, 1, PANEL_INDEX(2), PANEL_INDEX(2) + 5);
+  Knob knob(1);
+  knob.turn(10000, -40, 8000, 1000);              //10 clicks CCW
+  Board::place(11, 0, &knob);
+  Tally t;
+  runLoop(e, t, knob.end() + 10000, 200);
+  CHECK_EQUAL(10, t.ccw[2]);
+  CHECK_EQUAL(0, e.clicks(1));
+  CHECK_EQUAL(10, e.clicks(2));
+  CHECK_EQUAL(0, e.clicks(3));                    //No such encoder
+  CommonBusEncoders::Stats s;
+  e.stats(s);
+  CHECK(s.reads > 0);
+  CHECK(s.unsettled > 0);                         //The bounces
+  CHECK_EQUAL(0, s.illegal);
+  CHECK_EQUAL(1, s.focusSwitches);
+  unsigned long histogram = 0;
+  for (int b = 0 ; b < CBE_STATS_BUCKETS ; b++) histogram += s.readHistogram[b];
+  CHECK_EQUAL(s.reads, histogram);
+  e.resetStats();
+  e.stats(s);
+  CHECK_EQUAL(0, s.reads);
+  CHECK_EQUAL(0, e.clicks(2));
+}
+
+#endif
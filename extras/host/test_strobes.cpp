@@ -0,0 +1,178 @@
+/*
+  test_strobes.cpp
+  Released into the public domain.
+
+  Strobe devices (strobes) : one select() per encoder read, and what the expanders write on their bus
+*/
+
+#include "Test.h"
+#include "Panel.h"
+#include "Knob.h"
+#include "MCP23017Strobe.h"
+#include "SPIStrobes.h"
+
+//CountingStrobe==================================================================
+//A BoardStrobe that counts the selects of each line
+//--------------------------------------------------------------------------------
+class CountingStrobe : public BoardStrobe
+{
+  public:
+    int selects[PANEL_MAX] = {};                  //select() calls for each line
+    int disables = 0;                             //select(-1) calls
+    void select(int line) {
+      if (line >= 0) selects[line]++;
+      else           disables++;
+      BoardStrobe::select(line);
+    }
+    void clear() { memset(selects, 0, sizeof(selects)); disables = 0; }
+    bool once(int lines) {                        //Every one of the first "lines" lines selected once, no other
+      for (int l = 0 ; l < PANEL_MAX ; l++) if (selects[l] != (l < lines ? 1 : 0)) return false;
+      return disables == 0;
+    }
+};
+
+//bank============================================================================
+//"n" encoders on the lines of "strobe", in "banks" banks (busses 0, 1, 2, then 3, 4, 5...)
+//--------------------------------------------------------------------------------
+static const byte pinsA[4] = {0, 3, 6, 9};
+static const byte pinsB[4] = {1, 4, 7, 10};
+static const byte pinsS[4] = {2, 5, 8, 11};
+
+static CommonBusEncoders *bank(int n, int banks, CommonBusStrobe *strobe) {
+  for (int b = 0 ; b < banks ; b++) Board::busses(b, pinsA[b], pinsB[b], pinsS[b]);
+  CommonBusEncoders *e = (banks == 1) ? new CommonBusEncoders(0, 1, 2, n, strobe)
+                                      : new CommonBusEncoders(pinsA, pinsB, pinsS, banks, n, strobe);
+  for (int id = 1 ; id <= n ; id++) e->addEncoder(id, 4, (id - 1) / banks, 1, PANEL_INDEX(id), PANEL_INDEX(id) + 5);
+  return e;
+}
+
+//Every encoder read is a single select() of it's line, and nothing else : readAll(), full scan and tick()
+TEST(oneSelectPerRead) {
+  CountingStrobe strobe;
+  CommonBusEncoders *e = bank(96, 1, &strobe);
+  CHECK(strobe.once(0));                          //Nothing is selected by the constructor
+  e->readAll();                                   //No encoder active : every encoder is read
+  CHECK(strobe.once(96));
+  CHECK_EQUAL(96, strobe.transfers());
+  strobe.clear();
+  e->setFullScan(true);
+  e->readAll();
+  CHECK(strobe.once(96));
+  strobe.clear();
+  for (int n = 0 ; n < 96 ; n++) e->tick();       //One encoder per tick
+  CHECK(strobe.once(96));
+  CHECK_EQUAL(3 * 96, strobe.transfers());
+  delete e;
+}
+
+//With several banks, one select() reads the encoders of every bank on that line
+TEST(oneSelectPerCommonPin) {
+  CountingStrobe strobe;
+  CommonBusEncoders *e = bank(128, 4, &strobe);
+  e->readAll();
+  CHECK(strobe.once(32));
+  delete e;
+}
+
+//While a knob is turned, each readAll() reads it and one idle encoder : two selects
+TEST(twoSelectsWhileActive) {
+  CountingStrobe strobe;
+  Board::busses(0, 0, 1, 2);
+  Knob knob(1);
+  knob.turn(10000, 40, 8000);
+  Board::place(STROBE_LINE + 40, 0, &knob);
+  CommonBusEncoders *e = bank(64, 1, &strobe);
+  Tally t;
+  int calls = 0, idle = 0, active = 0;
+  while (Board::now < knob.end() + 10000) {
+    unsigned long before = strobe.transfers();
+    t.count(e->readAll());
+    unsigned long selects = strobe.transfers() - before;
+    calls++;
+    if (selects == 64) idle++;
+    if (selects == 2)  active++;
+    Board::advance(200);
+  }
+  CHECK_EQUAL(10, t.cw[41]);
+  CHECK_EQUAL(calls, idle + active);
+  CHECK(active > 0);
+  delete e;
+}
+
+//MCP23017 : one transmission per line on the same chip, an extra one to disable the chip left behind
+TEST(mcp23017MovesBetweenChips) {
+  MCP23017Strobe strobe(0x20, 4);
+  strobe.begin();
+  CHECK_EQUAL(8, Wire.count);                     //Latches HIGH, then outputs, on every chip
+  Wire.clear();
+  strobe.select(0);
+  strobe.select(1);
+  CHECK_EQUAL(2, Wire.count);
+  CHECK_EQUAL(2, strobe.transfers());
+  CHECK_EQUAL(0x20, Wire.last().address);
+  CHECK_EQUAL(0x14, Wire.last().bytes[0]);        //OLATA, then OLATB
+  CHECK_EQUAL(0xfd, Wire.last().bytes[1]);
+  CHECK_EQUAL(0xff, Wire.last().bytes[2]);
+  strobe.select(17);                              //GPA1 of the second chip
+  CHECK_EQUAL(4, Wire.count);
+  CHECK_EQUAL(4, strobe.transfers());
+  CHECK_EQUAL(0x20, Wire.at(2).address);          //The first chip, every line HIGH
+  CHECK_EQUAL(0xff, Wire.at(2).bytes[1]);
+  CHECK_EQUAL(0xff, Wire.at(2).bytes[2]);
+  CHECK_EQUAL(0x21, Wire.at(3).address);          //Then the second chip, it's line LOW
+  CHECK_EQUAL(0xfd, Wire.at(3).bytes[1]);
+  CHECK_EQUAL(0xff, Wire.at(3).bytes[2]);
+  strobe.select(-1);                              //Disable all : only the chip in use
+  CHECK_EQUAL(5, Wire.count);
+  CHECK_EQUAL(0x21, Wire.last().address);
+  CHECK_EQUAL(0xff, Wire.last().bytes[1]);
+}
+
+//MCP23S17 : the same on the SPI bus, the chip being in the opcode
+TEST(mcp23s17MovesBetweenChips) {
+  MCP23S17Strobe strobe(53, 4);
+  strobe.begin();
+  CHECK_EQUAL(9, SPI.count);                      //IOCON.HAEN, then latches and outputs on every chip
+  SPI.clear();
+  strobe.select(40);                              //GPB0 of the third chip
+  CHECK_EQUAL(1, SPI.count);
+  CHECK_EQUAL(0x44, SPI.last().bytes[0]);         //Write opcode, chip 2
+  CHECK_EQUAL(0x14, SPI.last().bytes[1]);
+  CHECK_EQUAL(0xff, SPI.last().bytes[2]);
+  CHECK_EQUAL(0xfe, SPI.last().bytes[3]);
+  strobe.select(41);
+  CHECK_EQUAL(2, SPI.count);
+  strobe.select(3);                               //GPA3 of the first chip
+  CHECK_EQUAL(4, SPI.count);
+  CHECK_EQUAL(4, strobe.transfers());
+  CHECK_EQUAL(0x44, SPI.at(2).bytes[0]);          //The third chip, every line HIGH
+  CHECK_EQUAL(0xff, SPI.at(2).bytes[2]);
+  CHECK_EQUAL(0xff, SPI.at(2).bytes[3]);
+  CHECK_EQUAL(0x40, SPI.at(3).bytes[0]);          //Then the first chip, it's line LOW
+  CHECK_EQUAL(0xf7, SPI.at(3).bytes[2]);
+  CHECK_EQUAL(0xff, SPI.at(3).bytes[3]);
+}
+
+//A full scan of 64 encoders on four MCP23017 : one transfer per encoder, plus one per change of chip
+TEST(mcp23017FullScan) {
+  MCP23017Strobe strobe(0x20, 4);
+  strobe.begin();
+  CommonBusEncoders *e = bank(64, 1, &strobe);
+  e->setFullScan(true);
+  e->readAll();                                   //Chips 0, 1, 2, 3 : 3 changes
+  CHECK_EQUAL(64 + 3, strobe.transfers());
+  e->readAll();                                   //From chip 3 back to chip 0 : 4 changes
+  CHECK_EQUAL(2 * 64 + 3 + 4, strobe.transfers());
+  delete e;
+}
+
+//74HC595 on the SPI bus : the whole chain in one transaction, the last chip first
+TEST(spiShiftRegistersShiftTheChain) {
+  SPIShiftRegisterStrobe strobe(53, 8);
+  strobe.begin();
+  SPI.clear();
+  strobe.select(10);                              //Output 2 of the second chip
+  CHECK_EQUAL(1, SPI.count);
+  CHECK_EQUAL(8, SPI.last().length);
+  for (int b = 0 ; b < 8 ; b++) CHECK_EQUAL(b == 6 ? 0xfb : 0xff, SPI.last().bytes[b]);
+}
@@ -0,0 +1,78 @@
+/*
+  test_switch.cpp
+  Released into the public domain.
+
+  The switch of an encoder (switch) : press, release and long press, one read each millisecond
+*/
+
+#include "Test.h"
+#include "Panel.h"
+
+static Recording contacts;
+
+//pressed=========================================================================
+//One encoder on pin 10, read without debouncing, it's switch closed at 1000ms
+//--------------------------------------------------------------------------------
+static CommonBusEncoders *pressed() {
+  CommonBusEncoders *e = recorded(contacts);
+  e->setSwitchIndexes(1, PANEL_INDEX(1) + 6, PANEL_INDEX(1) + 7);
+  e->setDebounce(1);
+  Board::advance(1000000 - Board::now);
+  contacts.s = true;
+  return e;
+}
+
+//heldFor=========================================================================
+//Reads the switch once each millisecond and returns the time from the press to the long press (-1 : never, within "limit")
+//--------------------------------------------------------------------------------
+static long heldFor(CommonBusEncoders &e, long limit) {
+  unsigned long at = 0;
+  for (long ms = 0 ; ms <= limit ; ms++) {
+    int index = e.readAll();
+    if (index == PANEL_INDEX(1) + 5) at = millis();
+    if (index == PANEL_INDEX(1) + 7) return millis() - at;
+    Board::advance(1000 - Board::now % 1000);
+  }
+  return -1;
+}
+
+//Press, long press and release, each reported once
+TEST(pressHoldRelease) {
+  CommonBusEncoders *e = pressed();
+  CHECK_EQUAL(1000, heldFor(*e, 2000));
+  for (int n = 0 ; n < 10 ; n++) CHECK_EQUAL(0, e->readAll());
+  contacts.s = false;
+  CHECK_EQUAL(PANEL_INDEX(1) + 6, e->readAll());
+  CHECK_EQUAL(0, e->readAll());
+  delete e;
+}
+
+//The type of the parameter of a method
+template <class M> struct Parameter;
+template <class C, class P> struct Parameter<void (C::*)(P)> { typedef P type; };
+
+//The whole range must be given on a board where int is 16 bits (40000 must not become -25536) : an unsigned delay
+static_assert(Parameter<decltype(&CommonBusEncoders::setLongPress)>::type(-1) > 0, "setLongPress() takes an unsigned delay");
+
+//The long press delay is kept within 0..65535ms, the press time being held on 16 bits
+TEST(longPressLimits) {
+  CommonBusEncoders *e = pressed();
+  e->setLongPress(250);
+  CHECK_EQUAL(250, heldFor(*e, 1000));
+  delete e;
+  Board::reset();
+  e = pressed();
+  e->setLongPress(0);
+  CHECK_EQUAL(1, heldFor(*e, 10));                //On the next read : one step per read
+  delete e;
+  Board::reset();
+  e = pressed();
+  e->setLongPress(40000);                         //Beyond a 16 bits int
+  CHECK_EQUAL(40000, heldFor(*e, 50000));
+  delete e;
+  Board::reset();
+  e = pressed();
+  e->setLongPress(100000);                        //Would never be reached past 65535ms
+  CHECK_EQUAL(65535, heldFor(*e, 70000));
+  delete e;
+}
@@ -0,0 +1,29 @@
+/*
+  tests.cpp
+  Released into the public domain.
+
+  Runs every TEST (see Test.h)
+*/
+
+#include "Test.h"
+#include "Board.h"
+
+int testFailures = 0;
+static TestCase *tests = NULL;
+
+TestCase::TestCase(const char *name, void (*run)()) : name(name), run(run), next(tests) {
+  tests = this;
+}
+
+int main() {
+  int count = 0, failed = 0;
+  for (TestCase *t = tests ; t != NULL ; t = t->next) {
+    int before = testFailures;
+    Board::reset();
+    t->run();
+    count++;
+    if (testFailures != before) { printf("FAIL %s\n", t->name); failed++; }
+  }
+  printf("%d tests, %d failed\n", count, failed);
+  return failed != 0;
+}